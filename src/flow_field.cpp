@@ -0,0 +1,336 @@
+#include "flow_field.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+    const int DIRECTION_X[4] = {1, -1, 0, 0};
+    const int DIRECTION_Y[4] = {0, 0, 1, -1};
+
+    // More journal entries than this are cheaper to handle with one full BFS
+    const size_t INCREMENTAL_CHANGE_LIMIT = 64;
+
+    // marks_ values during an update
+    const uint8_t UNMARKED = 0;
+    const uint8_t AFFECTED = 1;
+    const uint8_t SETTLED = 2;
+}
+
+FlowField::FlowField(const Tilemap& map)
+    : map_(map), width_(0), height_(0), targetX_(0), targetY_(0),
+      valid_(false), fieldTargetX_(0), fieldTargetY_(0), revision_(0), bias_(0) {
+}
+
+void FlowField::setTarget(int x, int y) {
+    targetX_ = x;
+    targetY_ = y;
+}
+
+int FlowField::distance(int x, int y) const {
+    if (!valid_ || x < 0 || y < 0 || x >= width_ || y >= height_) {
+        return UNREACHABLE;
+    }
+    return get(y * width_ + x);
+}
+
+bool FlowField::nextStep(int x, int y, int& stepX, int& stepY) const {
+    int best = distance(x, y);
+    if (best == UNREACHABLE || best == 0) {
+        return false;
+    }
+
+    bool found = false;
+    for (int i = 0; i < 4; ++i) {
+        int d = distance(x + DIRECTION_X[i], y + DIRECTION_Y[i]);
+        if (d < best) {
+            best = d;
+            stepX = DIRECTION_X[i];
+            stepY = DIRECTION_Y[i];
+            found = true;
+        }
+    }
+    return found;
+}
+
+void FlowField::update() {
+    auto start = std::chrono::steady_clock::now();
+
+    size_t touched = 0;
+    bool full = !valid_ || width_ != map_.getWidth() || height_ != map_.getHeight();
+
+    // Solidity changes since the field was built, each tile once with its final state
+    if (!full) {
+        changes_.clear();
+        full = !map_.solidChangesSince(revision_, changes_) || changes_.size() > INCREMENTAL_CHANGE_LIMIT;
+    }
+
+    for (size_t i = 0; !full && i < changes_.size(); ++i) {
+        const int x = changes_[i].x;
+        const int y = changes_[i].y;
+        const int index = y * width_ + x;
+        const bool solid = map_.isSolid(x, y);
+        if (solid == (solid_[index] != 0)) {
+            continue;
+        }
+
+        if (x == fieldTargetX_ && y == fieldTargetY_) {
+            full = true;
+        } else if (solid) {
+            touched += closeTile(x, y);
+        } else {
+            touched += openTile(x, y);
+        }
+    }
+
+    // Target moves between neighboring open tiles shift the field; anything else rebuilds it
+    if (!full && (targetX_ != fieldTargetX_ || targetY_ != fieldTargetY_)) {
+        bool adjacent = std::abs(targetX_ - fieldTargetX_) + std::abs(targetY_ - fieldTargetY_) == 1;
+        if (adjacent && open(targetX_, targetY_) && open(fieldTargetX_, fieldTargetY_)) {
+            touched += moveTarget(targetX_, targetY_);
+        } else {
+            full = true;
+        }
+    }
+
+    if (full) {
+        touched = recomputeAll();
+    }
+
+    revision_ = map_.getSolidRevision();
+    fieldTargetX_ = targetX_;
+    fieldTargetY_ = targetY_;
+    valid_ = true;
+
+    stats_.full = full;
+    stats_.cellsTouched = touched;
+    stats_.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stats_.totalMilliseconds += stats_.milliseconds;
+    if (full) {
+        ++stats_.fullRecomputes;
+    } else {
+        ++stats_.incrementalUpdates;
+    }
+}
+
+size_t FlowField::recomputeAll() {
+    width_ = map_.getWidth();
+    height_ = map_.getHeight();
+    const size_t count = static_cast<size_t>(width_) * height_;
+
+    stored_.assign(count, UNREACHABLE);
+    marks_.assign(count, UNMARKED);
+    bias_ = 0;
+
+    // Snapshot of the solidity this field describes
+    solid_.resize(count);
+    for (int y = 0; y < height_; ++y) {
+        if (map_.isPaged()) {
+            for (int x = 0; x < width_; ++x) {
+                solid_[y * width_ + x] = map_.isSolid(x, y);
+            }
+            continue;
+        }
+        const uint64_t* row = map_.solidRow(y);
+        for (int x = 0; x < width_; ++x) {
+            solid_[y * width_ + x] = Tilemap::testBit(row, x);
+        }
+    }
+
+    if (!open(targetX_, targetY_)) {
+        return count;
+    }
+
+    // Plain BFS from the target
+    queue_.clear();
+    queue_.push_back(targetY_ * width_ + targetX_);
+    put(queue_[0], 0);
+    for (size_t head = 0; head < queue_.size(); ++head) {
+        const int index = queue_[head];
+        const int x = index % width_;
+        const int y = index / width_;
+        const int next = get(index) + 1;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + DIRECTION_X[i];
+            int ny = y + DIRECTION_Y[i];
+            if (open(nx, ny) && get(ny * width_ + nx) == UNREACHABLE) {
+                put(ny * width_ + nx, next);
+                queue_.push_back(ny * width_ + nx);
+            }
+        }
+    }
+    return count;
+}
+
+size_t FlowField::moveTarget(int x, int y) {
+    // The grid is bipartite, so every reachable distance changes by exactly one.
+    // It drops for cells with a shortest path through the new target: those reached
+    // from it by only ever stepping one further away from the old target.
+    queue_.clear();
+    queue_.push_back(y * width_ + x);
+    marks_[queue_[0]] = AFFECTED;
+    for (size_t head = 0; head < queue_.size(); ++head) {
+        const int index = queue_[head];
+        const int cx = index % width_;
+        const int cy = index / width_;
+        const int uphill = get(index) + 1;
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + DIRECTION_X[i];
+            int ny = cy + DIRECTION_Y[i];
+            int neighbor = ny * width_ + nx;
+            if (open(nx, ny) && marks_[neighbor] == UNMARKED && get(neighbor) == uphill) {
+                marks_[neighbor] = AFFECTED;
+                queue_.push_back(neighbor);
+            }
+        }
+    }
+
+    // Everything else moves one step further away
+    ++bias_;
+    for (int index : queue_) {
+        stored_[index] -= 2;
+        marks_[index] = UNMARKED;
+    }
+
+    // Keep stored values well inside int32 over long sessions
+    if (bias_ > (1 << 30)) {
+        for (int32_t& value : stored_) {
+            if (value != UNREACHABLE) value += bias_;
+        }
+        bias_ = 0;
+    }
+    return queue_.size();
+}
+
+size_t FlowField::openTile(int x, int y) {
+    const int index = y * width_ + x;
+    solid_[index] = 0;
+
+    // Best route through an open neighbor, then flood the shorter paths outwards
+    int best = UNREACHABLE;
+    for (int i = 0; i < 4; ++i) {
+        int d = distance(x + DIRECTION_X[i], y + DIRECTION_Y[i]);
+        if (d != UNREACHABLE) best = std::min(best, d + 1);
+    }
+    if (best == UNREACHABLE) {
+        return 1;
+    }
+
+    put(index, best);
+    queue_.clear();
+    queue_.push_back(index);
+    for (size_t head = 0; head < queue_.size(); ++head) {
+        const int current = queue_[head];
+        const int cx = current % width_;
+        const int cy = current / width_;
+        const int next = get(current) + 1;
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + DIRECTION_X[i];
+            int ny = cy + DIRECTION_Y[i];
+            if (open(nx, ny) && get(ny * width_ + nx) > next) {
+                put(ny * width_ + nx, next);
+                queue_.push_back(ny * width_ + nx);
+            }
+        }
+    }
+    return queue_.size();
+}
+
+size_t FlowField::closeTile(int x, int y) {
+    const int index = y * width_ + x;
+    const int old = get(index);
+    solid_[index] = 1;
+    put(index, UNREACHABLE);
+    if (old == UNREACHABLE) {
+        return 1;
+    }
+
+    // Find the cells that lost every shortest path. Visiting them in distance order
+    // (BFS over cells one step further away) means a cell's closer neighbors are
+    // already classified when it is checked.
+    queue_.clear();
+    auto visitUphill = [&](int cx, int cy, int uphill) {
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + DIRECTION_X[i];
+            int ny = cy + DIRECTION_Y[i];
+            int neighbor = ny * width_ + nx;
+            if (open(nx, ny) && marks_[neighbor] == UNMARKED && get(neighbor) == uphill) {
+                marks_[neighbor] = SETTLED;
+                queue_.push_back(neighbor);
+            }
+        }
+    };
+
+    visitUphill(x, y, old + 1);
+    affected_.clear();
+    for (size_t head = 0; head < queue_.size(); ++head) {
+        const int current = queue_[head];
+        const int cx = current % width_;
+        const int cy = current / width_;
+        const int d = get(current);
+
+        bool supported = false;
+        for (int i = 0; i < 4 && !supported; ++i) {
+            int nx = cx + DIRECTION_X[i];
+            int ny = cy + DIRECTION_Y[i];
+            supported = open(nx, ny) && marks_[ny * width_ + nx] != AFFECTED && get(ny * width_ + nx) == d - 1;
+        }
+
+        if (!supported) {
+            marks_[current] = AFFECTED;
+            affected_.push_back(current);
+            visitUphill(cx, cy, d + 1);
+        }
+    }
+
+    // Re-settle the affected cells from their unaffected neighbors (Dijkstra, unit steps)
+    heap_.clear();
+    for (int current : affected_) {
+        put(current, UNREACHABLE);
+    }
+    for (int current : affected_) {
+        const int cx = current % width_;
+        const int cy = current / width_;
+        int best = UNREACHABLE;
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + DIRECTION_X[i];
+            int ny = cy + DIRECTION_Y[i];
+            if (open(nx, ny) && marks_[ny * width_ + nx] != AFFECTED) {
+                int d = get(ny * width_ + nx);
+                if (d != UNREACHABLE) best = std::min(best, d + 1);
+            }
+        }
+        if (best != UNREACHABLE) {
+            heap_.push_back({best, current});
+        }
+    }
+
+    std::make_heap(heap_.begin(), heap_.end(), std::greater<std::pair<int, int>>());
+    while (!heap_.empty()) {
+        std::pop_heap(heap_.begin(), heap_.end(), std::greater<std::pair<int, int>>());
+        const int d = heap_.back().first;
+        const int current = heap_.back().second;
+        heap_.pop_back();
+        if (d >= get(current)) {
+            continue;
+        }
+
+        put(current, d);
+        const int cx = current % width_;
+        const int cy = current / width_;
+        for (int i = 0; i < 4; ++i) {
+            int nx = cx + DIRECTION_X[i];
+            int ny = cy + DIRECTION_Y[i];
+            int neighbor = ny * width_ + nx;
+            if (open(nx, ny) && marks_[neighbor] == AFFECTED && d + 1 < get(neighbor)) {
+                heap_.push_back({d + 1, neighbor});
+                std::push_heap(heap_.begin(), heap_.end(), std::greater<std::pair<int, int>>());
+            }
+        }
+    }
+
+    for (int current : queue_) {
+        marks_[current] = UNMARKED;
+    }
+    return affected_.size() + 1;
+}
\ No newline at end of file
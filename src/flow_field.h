@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "tilemap.h"
+
+// Shared distance field towards one target tile (the player), for every chaser.
+// Distances are 4-connected BFS steps through non-solid tiles; monsters step to the
+// neighbor with the smallest distance.
+//
+// update() keeps the field current incrementally:
+//  - Target moved one tile: on a 4-connected grid every distance changes by exactly
+//    +1 or -1. Distances are stored relative to a shared bias, so only the cells that
+//    get closer (those with a shortest path through the new target) are rewritten.
+//  - Solidity changed (from Tilemap's change journal): an opened tile floods its
+//    shorter paths outwards; a closed tile re-settles only the cells whose every
+//    shortest path ran through it.
+// Anything else (map reload, big jumps, lost journal) falls back to a full BFS.
+class FlowField {
+public:
+    static constexpr int UNREACHABLE = INT32_MAX;
+
+    // Cost of the most recent update() and running totals
+    struct Stats {
+        bool full = false;             // Last update was a full recompute
+        size_t cellsTouched = 0;       // Cells written by the last update
+        double milliseconds = 0.0;     // Wall time of the last update
+        int fullRecomputes = 0;
+        int incrementalUpdates = 0;
+        double totalMilliseconds = 0.0;
+    };
+
+    explicit FlowField(const Tilemap& map);
+
+    // Takes effect on the next update()
+    void setTarget(int x, int y);
+    int getTargetX() const { return targetX_; }
+    int getTargetY() const { return targetY_; }
+
+    // Bring the field up to date with the target and the map
+    void update();
+
+    // Steps from (x, y) to the target, or UNREACHABLE (solid, outside, cut off, or no update yet)
+    int distance(int x, int y) const;
+
+    // Neighbor step (-1, 0 or 1 per axis) that gets closer to the target; false if none
+    bool nextStep(int x, int y, int& stepX, int& stepY) const;
+
+    const Stats& getStats() const { return stats_; }
+
+private:
+    const Tilemap& map_;
+    int width_;
+    int height_;
+    int targetX_;
+    int targetY_;
+
+    // State the field was computed for
+    bool valid_;
+    int fieldTargetX_;
+    int fieldTargetY_;
+    uint64_t revision_;
+
+    // distance = stored + bias_ for reachable cells; UNREACHABLE is stored as is
+    std::vector<int32_t> stored_;
+    int32_t bias_;
+
+    // Map solidity the field currently describes (1 = solid)
+    std::vector<uint8_t> solid_;
+
+    // Scratch buffers reused across updates
+    std::vector<int> queue_;
+    std::vector<int> affected_;
+    std::vector<std::pair<int, int>> heap_;  // (distance, cell) min-heap
+    std::vector<uint8_t> marks_;
+    std::vector<SolidChange> changes_;
+
+    Stats stats_;
+
+    bool open(int x, int y) const { return x >= 0 && y >= 0 && x < width_ && y < height_ && !solid_[y * width_ + x]; }
+    int get(int index) const { return stored_[index] == UNREACHABLE ? UNREACHABLE : stored_[index] + bias_; }
+    void put(int index, int value) { stored_[index] = value == UNREACHABLE ? UNREACHABLE : value - bias_; }
+
+    size_t recomputeAll();
+    size_t moveTarget(int x, int y);
+    size_t openTile(int x, int y);
+    size_t closeTile(int x, int y);
+};
\ No newline at end of file
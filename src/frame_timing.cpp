@@ -0,0 +1,125 @@
+#include "frame_timing.h"
+#include <SDL2/SDL.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+FrameStats::FrameStats()
+    : buckets_(BUCKET_COUNT, 0), frames_(0), missed_(0), totalMs_(0.0), maxMs_(0.0), targetMs_(1000.0 / 60.0) {
+}
+
+void FrameStats::record(double milliseconds) {
+    int bucket = static_cast<int>(milliseconds / BUCKET_MS);
+    ++buckets_[std::max(0, std::min(bucket, BUCKET_COUNT - 1))];
+    ++frames_;
+    totalMs_ += milliseconds;
+    maxMs_ = std::max(maxMs_, milliseconds);
+    if (milliseconds > targetMs_ * 1.5) {
+        ++missed_;
+    }
+}
+
+void FrameStats::reset() {
+    std::fill(buckets_.begin(), buckets_.end(), 0);
+    frames_ = 0;
+    missed_ = 0;
+    totalMs_ = 0.0;
+    maxMs_ = 0.0;
+}
+
+double FrameStats::percentile(double p) const {
+    if (frames_ == 0) {
+        return 0.0;
+    }
+
+    const double wanted = frames_ * p / 100.0;
+    uint64_t seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i) {
+        seen += buckets_[i];
+        if (seen >= wanted && seen > 0) {
+            return std::min((i + 1) * BUCKET_MS, maxMs_);
+        }
+    }
+    return maxMs_;
+}
+
+void FrameStats::print() const {
+    const std::ios::fmtflags flags = std::cout.flags();
+    const std::streamsize precision = std::cout.precision();
+    std::cout << std::fixed << std::setprecision(2)
+              << "Frame times: " << frames_ << " frames, avg " << getAverage() << " ms, p50 "
+              << percentile(50.0) << " ms, p99 " << percentile(99.0) << " ms, max " << maxMs_
+              << " ms, missed " << missed_ << " (target " << targetMs_ << " ms)" << std::endl;
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+}
+
+FixedTimestep::FixedTimestep(double tickSeconds, int maxTicksPerFrame)
+    : tickSeconds_(tickSeconds), maxTicksPerFrame_(maxTicksPerFrame), accumulator_(0.0), ticks_(0), dropped_(0) {
+}
+
+int FixedTimestep::advance(double frameSeconds) {
+    accumulator_ += frameSeconds;
+    int ticks = static_cast<int>(accumulator_ / tickSeconds_);
+    accumulator_ -= ticks * tickSeconds_;
+
+    if (ticks > maxTicksPerFrame_) {
+        dropped_ += ticks - maxTicksPerFrame_;
+        ticks = maxTicksPerFrame_;
+    }
+    ticks_ += ticks;
+    return ticks;
+}
+
+FramePacer::FramePacer(double targetHz)
+    : frequency_(SDL_GetPerformanceFrequency()), lastFrame_(0), nextFrame_(0), vsync_(false) {
+    interval_ = static_cast<uint64_t>(frequency_ / targetHz);
+    stats_.setTargetInterval(1000.0 / targetHz);
+}
+
+void FramePacer::setVsync(bool vsync, double refreshHz) {
+    vsync_ = vsync;
+    if (vsync && refreshHz > 0.0) {
+        // Frames are paced by the display, so that is what a missed frame is measured against
+        stats_.setTargetInterval(1000.0 / refreshHz);
+    } else {
+        stats_.setTargetInterval(1000.0 * interval_ / frequency_);
+    }
+}
+
+double FramePacer::beginFrame() {
+    const uint64_t now = SDL_GetPerformanceCounter();
+    if (lastFrame_ == 0) {
+        lastFrame_ = now;
+        return 0.0;
+    }
+
+    const double seconds = static_cast<double>(now - lastFrame_) / frequency_;
+    lastFrame_ = now;
+    stats_.record(seconds * 1000.0);
+    return seconds;
+}
+
+void FramePacer::waitForNextFrame() {
+    if (vsync_) {
+        return;
+    }
+
+    uint64_t now = SDL_GetPerformanceCounter();
+    nextFrame_ = nextFrame_ == 0 ? now + interval_ : nextFrame_ + interval_;
+
+    // Fell behind: start the schedule over instead of rushing the next frames
+    if (now >= nextFrame_) {
+        nextFrame_ = now;
+        return;
+    }
+
+    const uint64_t spinTicks = static_cast<uint64_t>(frequency_ * SPIN_MS / 1000.0);
+    while (now < nextFrame_) {
+        const uint64_t remaining = nextFrame_ - now;
+        if (remaining > spinTicks) {
+            SDL_Delay(static_cast<Uint32>((remaining - spinTicks) * 1000 / frequency_));
+        }
+        now = SDL_GetPerformanceCounter();
+    }
+}
\ No newline at end of file
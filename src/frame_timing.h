@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Frame time distribution over a run, for the summary printed on exit.
+// Times land in BUCKET_MS buckets; anything past the last bucket is counted in it.
+class FrameStats {
+public:
+    static constexpr double BUCKET_MS = 0.1;
+    static constexpr int BUCKET_COUNT = 1000;  // Up to 100 ms
+
+    FrameStats();
+
+    // Frames longer than 1.5x the interval count as missed
+    void setTargetInterval(double milliseconds) { targetMs_ = milliseconds; }
+    double getTargetInterval() const { return targetMs_; }
+
+    void record(double milliseconds);
+    void reset();
+
+    uint64_t getFrameCount() const { return frames_; }
+    uint64_t getMissedFrames() const { return missed_; }
+    double getAverage() const { return frames_ ? totalMs_ / frames_ : 0.0; }
+    double getMax() const { return maxMs_; }
+
+    // Frame time (bucket upper edge) that p percent of frames stay within
+    double percentile(double p) const;
+
+    // One line: frame count, average, p50, p99, max and missed frames
+    void print() const;
+
+private:
+    std::vector<uint32_t> buckets_;
+    uint64_t frames_;
+    uint64_t missed_;
+    double totalMs_;
+    double maxMs_;
+    double targetMs_;
+};
+
+// Turns real frame time into whole fixed-length simulation ticks.
+// Leftover time carries into the next frame; getAlpha() is how far the render is
+// between the last two ticks. A frame that would need more than maxTicksPerFrame
+// ticks (a stall, a debugger break) drops the backlog instead of trying to catch up.
+class FixedTimestep {
+public:
+    FixedTimestep(double tickSeconds, int maxTicksPerFrame);
+
+    // Number of ticks to simulate for a frame that took frameSeconds
+    int advance(double frameSeconds);
+
+    double getAlpha() const { return accumulator_ / tickSeconds_; }
+    double getTickSeconds() const { return tickSeconds_; }
+    uint64_t getTickCount() const { return ticks_; }
+    uint64_t getDroppedTicks() const { return dropped_; }
+
+private:
+    double tickSeconds_;
+    int maxTicksPerFrame_;
+    double accumulator_;
+    uint64_t ticks_;
+    uint64_t dropped_;
+};
+
+// Paces the main loop and measures frame times.
+// With vsync SDL_RenderPresent already blocks, so the pacer only measures. Without
+// it, waitForNextFrame() sleeps to the target rate: SDL_Delay for the bulk of the
+// wait, then a spin on the performance counter for the last SPIN_MS, since
+// SDL_Delay is only millisecond-accurate and often oversleeps.
+class FramePacer {
+public:
+    static constexpr double SPIN_MS = 2.0;
+
+    explicit FramePacer(double targetHz = 60.0);
+
+    void setVsync(bool vsync, double refreshHz = 60.0);
+    bool getVsync() const { return vsync_; }
+
+    // Seconds since the previous call (0 on the first); recorded in the stats
+    double beginFrame();
+
+    // Sleep until the next frame is due; no-op under vsync
+    void waitForNextFrame();
+
+    const FrameStats& getStats() const { return stats_; }
+
+private:
+    uint64_t frequency_;
+    uint64_t interval_;   // Performance counter ticks per frame
+    uint64_t lastFrame_;  // Counter at the previous beginFrame()
+    uint64_t nextFrame_;  // Counter the next frame is due at
+    bool vsync_;
+    FrameStats stats_;
+};
\ No newline at end of file
@@ -49,7 +49,7 @@ void updateVirtualInput() {
     if (input.keys[SDL_SCANCODE_S] || input.keys[SDL_SCANCODE_DOWN]) input.moveY += 1.0f;
     
     // Gamepad input
-    if (input.gamepadConnected && input.gamepad) {
+    if (input.gamepadConnected) {
         float leftX = input.gamepadAxes[SDL_CONTROLLER_AXIS_LEFTX];
         float leftY = input.gamepadAxes[SDL_CONTROLLER_AXIS_LEFTY];
         
@@ -174,13 +174,13 @@ void handleEvent(SDL_Event& e) {
             touch.active = true;
             touch.startX = touch.currentX = e.tfinger.x;
             touch.startY = touch.currentY = e.tfinger.y;
-            touch.startTime = SDL_GetTicks();
+            touch.startTime = e.tfinger.timestamp;  // Event time, so replays see the same taps
             break;
             
         case SDL_FINGERUP:
             // Check for tap (quick touch without much movement)
             if (touch.active) {
-                uint32_t duration = SDL_GetTicks() - touch.startTime;
+                uint32_t duration = e.tfinger.timestamp - touch.startTime;
                 float deltaX = touch.currentX - touch.startX;
                 float deltaY = touch.currentY - touch.startY;
                 float distance = std::sqrt(deltaX * deltaX + deltaY * deltaY);
@@ -202,6 +202,16 @@ void handleEvent(SDL_Event& e) {
     }
 }
 
+void handleReplayedEvent(SDL_Event& e) {
+    // The recorded pad is not plugged in now: restore its connection state only.
+    // Logs only hold the add and remove events that changed the active pad.
+    if (e.type == SDL_CONTROLLERDEVICEADDED || e.type == SDL_CONTROLLERDEVICEREMOVED) {
+        input.gamepadConnected = e.type == SDL_CONTROLLERDEVICEADDED;
+        return;
+    }
+    handleEvent(e);
+}
+
 void renderInputDebug(SDL_Renderer* renderer, int screenWidth, int screenHeight) {
     // Movement indicator (white square that moves based on input)
     if (input.moveX != 0.0f || input.moveY != 0.0f) {
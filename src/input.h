@@ -49,4 +49,5 @@ extern TouchState touch;
 void initializeGamepad();
 void updateVirtualInput();
 void handleEvent(SDL_Event& e);
+void handleReplayedEvent(SDL_Event& e);  // An event from an input log (see input_log.h)
 void renderInputDebug(SDL_Renderer* renderer, int screenWidth, int screenHeight);
\ No newline at end of file
@@ -0,0 +1,404 @@
+#include "input_log.h"
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const char MAGIC[4] = {'C', 'R', 'I', 'N'};
+
+    // Records
+    //   FRAME  uint32 tick, uint8 ticks, uint8 flags, uint16 eventCount, events
+    //   IDLE   uint8 ticks, uint16 frames    frames without events, each running ticks
+    //   END    uint32 tick, float cameraX, float cameraY
+    // Events: uint8 type, uint32 time (ms since recording began), payload by type
+    enum Record : uint8_t { RECORD_FRAME = 1, RECORD_IDLE = 2, RECORD_END = 3 };
+    const uint8_t FRAME_MAP_SWAPPED = 1u << 0;
+
+    enum EventType : uint8_t {
+        EVENT_KEY_DOWN = 1,     // uint16 scancode, uint8 repeat
+        EVENT_KEY_UP,           // uint16 scancode
+        EVENT_MOUSE_DOWN,       // uint8 button
+        EVENT_MOUSE_UP,         // uint8 button
+        EVENT_MOUSE_MOTION,     // int16 x, int16 y
+        EVENT_PAD_ADDED,
+        EVENT_PAD_REMOVED,
+        EVENT_PAD_DOWN,         // uint8 button
+        EVENT_PAD_UP,           // uint8 button
+        EVENT_PAD_AXIS,         // uint8 axis, int16 value
+        EVENT_FINGER_DOWN,      // float x, float y
+        EVENT_FINGER_UP,        // float x, float y
+        EVENT_FINGER_MOTION,    // float x, float y
+        EVENT_QUIT
+    };
+
+    template<class T>
+    void put(std::vector<uint8_t>& out, T value) {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<class T>
+    bool get(const uint8_t* data, size_t size, size_t& offset, T& value) {
+        if (size - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+}
+
+InputRecorder::~InputRecorder() {
+    // Not closed: keep what was recorded, a replay then reports the missing end state
+    if (file_.is_open()) {
+        flushIdle();
+    }
+}
+
+bool InputRecorder::open(const std::string& path, const InputSession& session) {
+    file_.open(path, std::ios::binary | std::ios::trunc);
+    if (!file_) {
+        std::cout << "Error: Could not create input log: " << path << std::endl;
+        return false;
+    }
+    path_ = path;
+
+    InputLogHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(InputLogHeader);
+    header.tickRate = session.tickRate;
+    header.flags = (session.gamepadConnected ? FLAG_GAMEPAD : 0) | (session.worldMode ? FLAG_WORLD : 0) |
+                   (session.pagedMap.empty() ? 0 : FLAG_PAGED_MAP);
+    header.mapCount = static_cast<uint32_t>(session.maps.size());
+    header.worldSeed = session.worldSeed;
+
+    std::vector<uint8_t> names;
+    for (const std::string& name : session.maps) {
+        put<uint16_t>(names, static_cast<uint16_t>(name.size()));
+        names.insert(names.end(), name.begin(), name.end());
+    }
+    if (!session.pagedMap.empty()) {
+        put<uint16_t>(names, static_cast<uint16_t>(session.pagedMap.size()));
+        names.insert(names.end(), session.pagedMap.begin(), session.pagedMap.end());
+    }
+    file_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file_.write(reinterpret_cast<const char*>(names.data()), names.size());
+
+    startTime_ = SDL_GetTicks();
+    events_.clear();
+    eventCount_ = 0;
+    idleTicks_ = -1;
+    idleFrames_ = 0;
+    return true;
+}
+
+void InputRecorder::record(const SDL_Event& e) {
+    if (!file_.is_open() || eventCount_ == UINT16_MAX) {
+        return;
+    }
+
+    const size_t start = events_.size();
+    const uint32_t time = e.common.timestamp >= startTime_ ? e.common.timestamp - startTime_ : 0;
+    auto begin = [&](EventType type) {
+        put<uint8_t>(events_, type);
+        put<uint32_t>(events_, time);
+    };
+
+    switch (e.type) {
+        case SDL_KEYDOWN:
+            begin(EVENT_KEY_DOWN);
+            put<uint16_t>(events_, static_cast<uint16_t>(e.key.keysym.scancode));
+            put<uint8_t>(events_, e.key.repeat);
+            break;
+        case SDL_KEYUP:
+            begin(EVENT_KEY_UP);
+            put<uint16_t>(events_, static_cast<uint16_t>(e.key.keysym.scancode));
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            begin(e.type == SDL_MOUSEBUTTONDOWN ? EVENT_MOUSE_DOWN : EVENT_MOUSE_UP);
+            put<uint8_t>(events_, e.button.button);
+            break;
+        case SDL_MOUSEMOTION:
+            begin(EVENT_MOUSE_MOTION);
+            put<int16_t>(events_, static_cast<int16_t>(e.motion.x));
+            put<int16_t>(events_, static_cast<int16_t>(e.motion.y));
+            break;
+        case SDL_CONTROLLERDEVICEADDED:
+            begin(EVENT_PAD_ADDED);
+            break;
+        case SDL_CONTROLLERDEVICEREMOVED:
+            begin(EVENT_PAD_REMOVED);
+            break;
+        case SDL_CONTROLLERBUTTONDOWN:
+        case SDL_CONTROLLERBUTTONUP:
+            begin(e.type == SDL_CONTROLLERBUTTONDOWN ? EVENT_PAD_DOWN : EVENT_PAD_UP);
+            put<uint8_t>(events_, e.cbutton.button);
+            break;
+        case SDL_CONTROLLERAXISMOTION:
+            begin(EVENT_PAD_AXIS);
+            put<uint8_t>(events_, e.caxis.axis);
+            put<int16_t>(events_, e.caxis.value);
+            break;
+        case SDL_FINGERDOWN:
+        case SDL_FINGERUP:
+        case SDL_FINGERMOTION:
+            begin(e.type == SDL_FINGERDOWN ? EVENT_FINGER_DOWN
+                  : e.type == SDL_FINGERUP ? EVENT_FINGER_UP : EVENT_FINGER_MOTION);
+            put<float>(events_, e.tfinger.x);
+            put<float>(events_, e.tfinger.y);
+            break;
+        case SDL_QUIT:
+            begin(EVENT_QUIT);
+            break;
+        default:
+            return;
+    }
+
+    if (events_.size() > start) {
+        ++eventCount_;
+    }
+}
+
+void InputRecorder::endFrame(uint32_t tick, int ticks, bool mapSwapped) {
+    if (!file_.is_open()) {
+        return;
+    }
+
+    // Most frames carry no input: count them instead of writing each one
+    if (eventCount_ == 0 && !mapSwapped) {
+        if (ticks != idleTicks_ || idleFrames_ == UINT16_MAX) {
+            flushIdle();
+            idleTicks_ = ticks;
+        }
+        ++idleFrames_;
+        return;
+    }
+
+    flushIdle();
+    std::vector<uint8_t> record;
+    put<uint8_t>(record, RECORD_FRAME);
+    put<uint32_t>(record, tick);
+    put<uint8_t>(record, static_cast<uint8_t>(ticks));
+    put<uint8_t>(record, mapSwapped ? FRAME_MAP_SWAPPED : 0);
+    put<uint16_t>(record, eventCount_);
+    file_.write(reinterpret_cast<const char*>(record.data()), record.size());
+    file_.write(reinterpret_cast<const char*>(events_.data()), events_.size());
+
+    events_.clear();
+    eventCount_ = 0;
+}
+
+bool InputRecorder::close(uint32_t tick, float cameraX, float cameraY) {
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    flushIdle();
+    std::vector<uint8_t> record;
+    put<uint8_t>(record, RECORD_END);
+    put<uint32_t>(record, tick);
+    put<float>(record, cameraX);
+    put<float>(record, cameraY);
+    file_.write(reinterpret_cast<const char*>(record.data()), record.size());
+    file_.close();
+
+    if (!file_) {
+        std::cout << "Error: Could not write input log: " << path_ << std::endl;
+        return false;
+    }
+    std::cout << "Recorded " << tick << " ticks of input to " << path_ << std::endl;
+    return true;
+}
+
+void InputRecorder::flushIdle() {
+    if (idleFrames_ > 0) {
+        std::vector<uint8_t> record;
+        put<uint8_t>(record, RECORD_IDLE);
+        put<uint8_t>(record, static_cast<uint8_t>(idleTicks_));
+        put<uint16_t>(record, idleFrames_);
+        file_.write(reinterpret_cast<const char*>(record.data()), record.size());
+    }
+    idleFrames_ = 0;
+    idleTicks_ = -1;
+}
+
+bool InputReplay::open(const std::string& path) {
+    if (!file_.open(path)) {
+        std::cout << "Error: Could not open input log: " << path << std::endl;
+        return false;
+    }
+    path_ = path;
+
+    const InputLogHeader* header = reinterpret_cast<const InputLogHeader*>(file_.data());
+    if (file_.size() < sizeof(InputLogHeader) || std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != InputRecorder::VERSION || header->headerSize != sizeof(InputLogHeader)) {
+        std::cout << "Error: Not a supported input log: " << path << std::endl;
+        file_.close();
+        return false;
+    }
+
+    session_ = InputSession();
+    session_.tickRate = header->tickRate;
+    session_.gamepadConnected = (header->flags & InputRecorder::FLAG_GAMEPAD) != 0;
+    session_.worldMode = (header->flags & InputRecorder::FLAG_WORLD) != 0;
+    session_.worldSeed = header->worldSeed;
+
+    offset_ = sizeof(InputLogHeader);
+    const bool pagedMap = (header->flags & InputRecorder::FLAG_PAGED_MAP) != 0;
+    for (uint32_t i = 0; i < header->mapCount + (pagedMap ? 1 : 0); ++i) {
+        uint16_t length = 0;
+        if (!get(file_.data(), file_.size(), offset_, length) || file_.size() - offset_ < length) {
+            std::cout << "Error: Input log is truncated: " << path << std::endl;
+            file_.close();
+            return false;
+        }
+        std::string name(reinterpret_cast<const char*>(file_.data() + offset_), length);
+        if (i < header->mapCount) {
+            session_.maps.push_back(std::move(name));
+        } else {
+            session_.pagedMap = std::move(name);
+        }
+        offset_ += length;
+    }
+
+    idleFrames_ = 0;
+    tick_ = 0;
+    ended_ = false;
+    return true;
+}
+
+bool InputReplay::nextFrame(Frame& frame) {
+    frame.events.clear();
+    frame.mapSwapped = false;
+
+    if (idleFrames_ == 0 && !ended_) {
+        const uint8_t* data = file_.data();
+        const size_t size = file_.size();
+        uint8_t record = 0;
+        bool valid = get(data, size, offset_, record);
+        if (valid && record == RECORD_FRAME) {
+            uint8_t ticks = 0, flags = 0;
+            uint16_t eventCount = 0;
+            valid = get(data, size, offset_, frame.tick) && get(data, size, offset_, ticks) &&
+                    get(data, size, offset_, flags) && get(data, size, offset_, eventCount);
+            frame.ticks = ticks;
+            frame.mapSwapped = (flags & FRAME_MAP_SWAPPED) != 0;
+            frame.events.resize(eventCount);
+            for (uint16_t i = 0; valid && i < eventCount; ++i) {
+                valid = readEvent(frame.events[i]);
+            }
+            if (valid) {
+                tick_ = frame.tick + frame.ticks;
+                return true;
+            }
+        } else if (valid && record == RECORD_IDLE) {
+            uint8_t ticks = 0;
+            valid = get(data, size, offset_, ticks) && get(data, size, offset_, idleFrames_) && idleFrames_ > 0;
+            idleTicks_ = ticks;
+        } else if (valid && record == RECORD_END) {
+            valid = get(data, size, offset_, endTick_) && get(data, size, offset_, endCameraX_) &&
+                    get(data, size, offset_, endCameraY_);
+            ended_ = valid;
+            return false;
+        } else {
+            valid = false;
+        }
+
+        if (!valid) {
+            // A recording cut short (crash, kill) still replays up to the damage
+            if (offset_ < size) {
+                std::cout << "Warning: Input log is truncated or corrupt: " << path_ << std::endl;
+            }
+            offset_ = size;
+            idleFrames_ = 0;
+            frame.events.clear();
+            return false;
+        }
+    }
+
+    if (idleFrames_ == 0) {
+        return false;
+    }
+    --idleFrames_;
+    frame.tick = tick_;
+    frame.ticks = idleTicks_;
+    tick_ += idleTicks_;
+    return true;
+}
+
+bool InputReplay::verify(uint32_t tick, float cameraX, float cameraY) const {
+    if (!ended_) {
+        std::cout << "Warning: Input log has no end state (recording did not exit cleanly)" << std::endl;
+        return false;
+    }
+    if (tick != endTick_ || cameraX != endCameraX_ || cameraY != endCameraY_) {
+        std::cout << "Warning: Replay diverged: " << tick << " ticks, camera " << cameraX << "," << cameraY
+                  << " (recorded " << endTick_ << " ticks, camera " << endCameraX_ << "," << endCameraY_ << ")"
+                  << std::endl;
+        return false;
+    }
+    std::cout << "Replay matched the recording: " << tick << " ticks" << std::endl;
+    return true;
+}
+
+bool InputReplay::readEvent(SDL_Event& e) {
+    const uint8_t* data = file_.data();
+    const size_t size = file_.size();
+    uint8_t type = 0;
+    uint32_t time = 0;
+    if (!get(data, size, offset_, type) || !get(data, size, offset_, time)) {
+        return false;
+    }
+
+    std::memset(&e, 0, sizeof(e));
+    e.common.timestamp = time;
+    uint16_t scancode = 0;
+    int16_t x = 0, y = 0;
+    switch (type) {
+        case EVENT_KEY_DOWN:
+            e.type = SDL_KEYDOWN;
+            e.key.state = SDL_PRESSED;
+            if (!get(data, size, offset_, scancode) || !get(data, size, offset_, e.key.repeat)) return false;
+            e.key.keysym.scancode = static_cast<SDL_Scancode>(scancode % SDL_NUM_SCANCODES);
+            return true;
+        case EVENT_KEY_UP:
+            e.type = SDL_KEYUP;
+            if (!get(data, size, offset_, scancode)) return false;
+            e.key.keysym.scancode = static_cast<SDL_Scancode>(scancode % SDL_NUM_SCANCODES);
+            return true;
+        case EVENT_MOUSE_DOWN:
+        case EVENT_MOUSE_UP:
+            e.type = type == EVENT_MOUSE_DOWN ? SDL_MOUSEBUTTONDOWN : SDL_MOUSEBUTTONUP;
+            return get(data, size, offset_, e.button.button);
+        case EVENT_MOUSE_MOTION:
+            e.type = SDL_MOUSEMOTION;
+            if (!get(data, size, offset_, x) || !get(data, size, offset_, y)) return false;
+            e.motion.x = x;
+            e.motion.y = y;
+            return true;
+        case EVENT_PAD_ADDED:
+            e.type = SDL_CONTROLLERDEVICEADDED;
+            return true;
+        case EVENT_PAD_REMOVED:
+            e.type = SDL_CONTROLLERDEVICEREMOVED;
+            return true;
+        case EVENT_PAD_DOWN:
+        case EVENT_PAD_UP:
+            e.type = type == EVENT_PAD_DOWN ? SDL_CONTROLLERBUTTONDOWN : SDL_CONTROLLERBUTTONUP;
+            return get(data, size, offset_, e.cbutton.button);
+        case EVENT_PAD_AXIS:
+            e.type = SDL_CONTROLLERAXISMOTION;
+            return get(data, size, offset_, e.caxis.axis) && get(data, size, offset_, e.caxis.value);
+        case EVENT_FINGER_DOWN:
+        case EVENT_FINGER_UP:
+        case EVENT_FINGER_MOTION:
+            e.type = type == EVENT_FINGER_DOWN ? SDL_FINGERDOWN
+                     : type == EVENT_FINGER_UP ? SDL_FINGERUP : SDL_FINGERMOTION;
+            return get(data, size, offset_, e.tfinger.x) && get(data, size, offset_, e.tfinger.y);
+        case EVENT_QUIT:
+            e.type = SDL_QUIT;
+            return true;
+    }
+    return false;
+}
\ No newline at end of file
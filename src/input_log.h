@@ -0,0 +1,113 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "map_format.h"
+
+// What a replay needs to start where the recording started
+struct InputSession {
+    uint32_t tickRate = 0;
+    bool gamepadConnected = false;  // A pad was open before the first event
+    std::vector<std::string> maps;  // Maps N cycles through, first one loaded at start
+    bool worldMode = false;         // Started in the endless maze world
+    uint32_t worldSeed = 0;
+    std::string pagedMap;           // Shown paged at start instead of maps[0]; empty for none
+};
+
+// Input log file (.crinput), little endian:
+//   InputLogHeader
+//   map names      mapCount times: uint16 length, then the name
+//   paged map      only with FLAG_PAGED_MAP: uint16 length, then the name
+//   records        FRAME, IDLE and a closing END record (see input_log.cpp)
+// Events are kept in the frame that handled them, with the number of simulation
+// ticks that frame ran, so a replay sees the same input on the same tick.
+#pragma pack(push, 1)
+struct InputLogHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t tickRate;
+    uint32_t flags;
+    uint32_t mapCount;
+    uint32_t worldSeed;
+};
+#pragma pack(pop)
+
+// Writes the input events of a session, one frame at a time
+class InputRecorder {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t FLAG_GAMEPAD = 1u << 0;
+    static constexpr uint32_t FLAG_WORLD = 1u << 1;
+    static constexpr uint32_t FLAG_PAGED_MAP = 1u << 2;
+
+    InputRecorder() = default;
+    ~InputRecorder();
+
+    InputRecorder(const InputRecorder&) = delete;
+    InputRecorder& operator=(const InputRecorder&) = delete;
+
+    bool open(const std::string& path, const InputSession& session);
+    bool isOpen() const { return file_.is_open(); }
+
+    // Keep e for the current frame if it is input; ignores everything else
+    void record(const SDL_Event& e);
+
+    // Close the current frame: tick is the tick count before it, ticks how many it ran
+    void endFrame(uint32_t tick, int ticks, bool mapSwapped);
+
+    // Finish the log with the end state a replay checks itself against
+    bool close(uint32_t tick, float cameraX, float cameraY);
+
+private:
+    void flushIdle();
+
+    std::ofstream file_;
+    std::string path_;
+    uint32_t startTime_ = 0;  // SDL ticks when recording began; event times are relative
+    std::vector<uint8_t> events_;
+    uint16_t eventCount_ = 0;
+    int idleTicks_ = -1;      // Run of frames without events that each ran idleTicks_ ticks
+    uint16_t idleFrames_ = 0;
+};
+
+// Reads a log back frame by frame
+class InputReplay {
+public:
+    struct Frame {
+        uint32_t tick = 0;         // Ticks simulated before this frame in the recording
+        int ticks = 0;             // Ticks to run after handling events
+        bool mapSwapped = false;   // A loaded map was swapped in at the start of the frame
+        std::vector<SDL_Event> events;
+    };
+
+    bool open(const std::string& path);
+    bool isOpen() const { return file_.isOpen(); }
+
+    const InputSession& getSession() const { return session_; }
+
+    // The next recorded frame; false once the log is over
+    bool nextFrame(Frame& frame);
+
+    // Compare the end state to the recording's, print the result; true if they match
+    bool verify(uint32_t tick, float cameraX, float cameraY) const;
+
+private:
+    bool readEvent(SDL_Event& e);
+
+    MappedFile file_;
+    std::string path_;
+    InputSession session_;
+    size_t offset_ = 0;
+    uint16_t idleFrames_ = 0;  // Left in the current IDLE run
+    int idleTicks_ = 0;
+    uint32_t tick_ = 0;        // Recorded tick count, kept through IDLE runs
+
+    bool ended_ = false;
+    uint32_t endTick_ = 0;
+    float endCameraX_ = 0.0f;
+    float endCameraY_ = 0.0f;
+};
\ No newline at end of file
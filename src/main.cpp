@@ -1,7 +1,18 @@
 #include <SDL2/SDL.h>
 #include <iostream>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include "frame_timing.h"
 #include "input.h"
+#include "input_log.h"
+#include "map_loader.h"
+#include "maze_world.h"
+#include "nav_graph.h"
+#include "profiler.h"
+#include "thread_pool.h"
 #include "tilemap.h"
 
 #ifdef __EMSCRIPTEN__
@@ -12,6 +23,14 @@
 const int SCREEN_WIDTH = 640;
 const int SCREEN_HEIGHT = 400;
 
+// Simulation runs at a fixed rate, independent of the display
+const double TICK_RATE = 60.0;
+const int MAX_TICKS_PER_FRAME = 5;
+
+// Maps parsed ahead of the current one in N order, and the threads parsing them
+const size_t MAP_PREFETCH_COUNT = 4;
+const unsigned MAP_PREFETCH_THREADS = 2;
+
 // Game window and renderer
 SDL_Window* window = nullptr;
 SDL_Renderer* renderer = nullptr;
@@ -19,73 +38,345 @@ bool running = true;
 
 // Game world
 Tilemap* tilemap = nullptr;
-int cameraX = 0, cameraY = 0;
+float cameraX = 0.0f, cameraY = 0.0f;                  // Camera after the latest tick
+float previousCameraX = 0.0f, previousCameraY = 0.0f;  // Camera after the tick before, for interpolation
 std::vector<std::string> availableMaps;
+std::string mapFilter;     // --map-filter: only maps whose name or preset contains this
+bool sortMapsBySize = false;
 int currentMapIndex = 0;
+MapCache mapCache;                   // Parsed maps, so switching back skips the parse
+AsyncMapLoader mapLoader(&mapCache);  // Maps switched with N load in the background
+ThreadPool* prefetchPool = nullptr;   // Workers parsing upcoming maps into mapCache
+std::string pagedMap;                 // --paged-map: binary map shown first, paged in on demand
+std::string currentPagedMap;          // Paged map on screen (or to return to from the world); empty when dense
+size_t pageBudget = TilePages::DEFAULT_BUDGET;  // --page-budget-mb
 
+// Endless maze world, toggled with M in place of the map list
+MazeWorld* world = nullptr;  // Created on first entry, kept so the world resumes where it was left
+bool worldMode = false;
+uint32_t worldSeed = 1;      // --world-seed
+bool startInWorld = false;   // --world, or a replay that started there
+float worldCameraX = 0.0f, worldCameraY = 0.0f;  // Camera when the world was left
 
+// Corridor graph of the map on screen, for long-range path queries
+NavGraph navGraph;
+size_t navGraphBuilds = 0;
+double navGraphSeconds = 0.0;
 
+// Frame pacing
+FramePacer pacer(TICK_RATE);
+FixedTimestep timestep(1.0 / TICK_RATE, MAX_TICKS_PER_FRAME);
+uint32_t simulationTick = 0;  // Ticks simulated since start
 
+// Input logs: --record writes one, --replay drives the game from one instead of live input
+InputRecorder inputRecorder;
+InputReplay inputReplay;
+bool replayTickWarned = false;
 
-void gameLoop() {
-    // Reset per-frame input state
-    input.reset();
-    
-    // Handle events
-    SDL_Event e;
-    while (SDL_PollEvent(&e)) {
-        if (e.type == SDL_QUIT) {
-            running = false;
-        }
-        
-        // Special case: ESC to quit (useful for web version)
-        if (e.type == SDL_KEYDOWN && e.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
-            running = false;
-        }
-        
-        handleEvent(e);
+// Profiler overlay and trace output (CROSSROADS_PROFILING builds)
+bool showProfiler = false;
+std::string traceFile = "crossroads_trace.json";
+bool traceOnExit = false;
+
+
+
+
+
+// Center the camera on the map without interpolating from the old position
+void centerCamera() {
+    cameraX = previousCameraX = static_cast<float>((tilemap->getWidth() * TILE_SIZE - SCREEN_WIDTH) / 2);
+    cameraY = previousCameraY = static_cast<float>((tilemap->getHeight() * TILE_SIZE - SCREEN_HEIGHT) / 2);
+}
+
+// Keep the world window around the camera; the camera moves with the window
+void followWorld() {
+    PROFILE_SCOPE("world");
+    int shiftX = 0, shiftY = 0;
+    if (world->follow(*tilemap, cameraX + SCREEN_WIDTH / 2, cameraY + SCREEN_HEIGHT / 2, shiftX, shiftY)) {
+        cameraX -= shiftX;
+        cameraY -= shiftY;
+        previousCameraX -= shiftX;
+        previousCameraY -= shiftY;
     }
+}
+
+// One fixed simulation tick
+void simulate() {
+    ++simulationTick;
+    previousCameraX = cameraX;
+    previousCameraY = cameraY;
     
-    // Update virtual input state
-    updateVirtualInput();
-    
-    // Update camera based on input
+    // Update camera based on input (pixels per tick)
     const float cameraSpeed = 2.0f;
-    cameraX += (int)(input.moveX * cameraSpeed);
-    cameraY += (int)(input.moveY * cameraSpeed);
+    cameraX += input.moveX * cameraSpeed;
+    cameraY += input.moveY * cameraSpeed;
+    
+    if (worldMode) {
+        followWorld();
+        return;
+    }
     
     // Clamp camera to map bounds
-    int maxCameraX = std::max(0, tilemap->getWidth() * TILE_SIZE - SCREEN_WIDTH);
-    int maxCameraY = std::max(0, tilemap->getHeight() * TILE_SIZE - SCREEN_HEIGHT);
-    cameraX = std::max(0, std::min(cameraX, maxCameraX));
-    cameraY = std::max(0, std::min(cameraY, maxCameraY));
+    float maxCameraX = static_cast<float>(std::max(0, tilemap->getWidth() * TILE_SIZE - SCREEN_WIDTH));
+    float maxCameraY = static_cast<float>(std::max(0, tilemap->getHeight() * TILE_SIZE - SCREEN_HEIGHT));
+    cameraX = std::max(0.0f, std::min(cameraX, maxCameraX));
+    cameraY = std::max(0.0f, std::min(cameraY, maxCameraY));
+}
+
+// Binary maps whose planes would pass this are paged rather than loaded dense. A
+// constant rather than --page-budget-mb, so a replay takes the recording's route.
+const size_t PAGED_MAP_BYTES = size_t(64) << 20;
+
+bool isPagedMap(const std::string& name) {
+    int width = 0;
+    int height = 0;
+    return MapFormat::hasExtension(name, MapFormat::BINARY_EXTENSION) &&
+           MapFormat::readSize("assets/maps/" + name, width, height) &&
+           TileBuffer::bytesFor(width, height) > PAGED_MAP_BYTES;
+}
+
+// Show name paged, replacing any map still loading; opening it reads no tiles
+bool loadPagedMap(const std::string& name) {
+    mapLoader.cancel();
+    if (!tilemap->loadPaged(name, pageBudget)) {
+        return false;
+    }
+    currentPagedMap = name;
+    return true;
+}
+
+// Switch to a map from the list: huge ones at once and paged, others in the background
+void requestMap(const std::string& name) {
+    if (!isPagedMap(name)) {
+        mapLoader.request(name);
+    } else if (loadPagedMap(name)) {
+        centerCamera();
+    }
+}
+
+// Parse the next few maps in cycling order ahead of time (paged maps are never parsed)
+void prefetchNeighborMaps() {
+    if (!prefetchPool || availableMaps.size() < 2) {
+        return;
+    }
+    
+    std::vector<std::string> upcoming;
+    for (size_t i = 1; i <= MAP_PREFETCH_COUNT && i < availableMaps.size(); ++i) {
+        const std::string& name = availableMaps[(currentMapIndex + i) % availableMaps.size()];
+        if (!isPagedMap(name)) {
+            upcoming.push_back(name);
+        }
+    }
+    mapCache.prefetch(upcoming, *prefetchPool);
+}
+
+void printMapCacheStats() {
+    MapCache::Stats stats = mapCache.getStats();
+    std::cout << "Map cache: " << mapCache.getCount() << " maps, " << mapCache.getBytes() / 1024 << " KB of "
+              << mapCache.getBudget() / 1024 << " KB, " << stats.hits << " hits, " << stats.misses << " misses, "
+              << stats.evictions << " evictions, " << stats.prefetched << " prefetched" << std::endl;
+}
+
+// Frame boundary: show a map that finished loading in the background. Replays
+// and headless runs wait for the load so the swap lands on a set frame.
+bool swapLoadedMap(bool wait = false) {
+    PROFILE_SCOPE("map.swap");
+    if (wait) {
+        mapLoader.wait();
+    }
+    
+    std::string loaded;
+    if (!mapLoader.poll(*tilemap, loaded)) {
+        return false;
+    }
+    std::cout << "Loaded map: " << loaded << " (" << tilemap->getWidth() << "x"
+              << tilemap->getHeight() << ")" << std::endl;
+    currentPagedMap.clear();
+    centerCamera();
+    return true;
+}
+
+// Pick the maps N cycles through (the recorded ones when replaying) and show the first
+void loadFirstMap() {
+    availableMaps = inputReplay.isOpen() ? inputReplay.getSession().maps
+                                         : tilemap->getAvailableMaps(mapFilter, sortMapsBySize);
+    if (!pagedMap.empty() && loadPagedMap(pagedMap)) {
+        // N goes on to the map list as usual
+    } else if (!availableMaps.empty()) {
+        if (!isPagedMap(availableMaps[0]) || !loadPagedMap(availableMaps[0])) {
+            tilemap->loadMap(availableMaps[0]);
+        }
+    } else {
+        std::cout << "Warning: No maps found, using test pattern" << std::endl;
+        tilemap->generateTestMap();
+    }
+    centerCamera();
+}
+
+// Switch between the map list and the endless world. The map comes back through
+// the background loader (usually from the cache); the world resumes where it was.
+void toggleWorld() {
+    worldMode = !worldMode;
+    if (worldMode) {
+        mapLoader.cancel();
+        if (!world) {
+            world = new MazeWorld(worldSeed);
+            world->enter(*tilemap, 0, 0);
+            centerCamera();
+        } else {
+            world->enter(*tilemap, world->getCenterX(), world->getCenterY());
+            cameraX = previousCameraX = worldCameraX;
+            cameraY = previousCameraY = worldCameraY;
+        }
+        std::cout << "World mode: seed " << world->getSeed() << ", chunk " << world->getCenterX() << ","
+                  << world->getCenterY() << std::endl;
+        return;
+    }
     
-    // Cycle through different maps with 'n' key
-    if (input.keysPressed[SDL_SCANCODE_N]) {
+    worldCameraX = cameraX;
+    worldCameraY = cameraY;
+    std::cout << "Map mode" << std::endl;
+    if (!currentPagedMap.empty() && loadPagedMap(currentPagedMap)) {
+        centerCamera();
+    } else if (!availableMaps.empty()) {
+        requestMap(availableMaps[currentMapIndex]);
+    } else {
+        tilemap->generateTestMap();
+        centerCamera();
+    }
+}
+
+// Maps with more tiles than this (and paged maps) get no nav graph: building one
+// stalls the frame for 50 ms on a 1000 x 700 maze, and open floor makes every tile
+// a node, so a 3000 x 2000 open map takes over a second
+const long NAV_GRAPH_MAX_TILES = 1L << 20;
+
+// Rebuild the nav graph once the map's solidity changed: a new map, tile edits or
+// the world window moving
+void updateNavGraph() {
+    if (!navGraph.isStale(*tilemap)) {
+        return;
+    }
+    if (tilemap->isPaged() || static_cast<long>(tilemap->getWidth()) * tilemap->getHeight() > NAV_GRAPH_MAX_TILES) {
+        navGraph = NavGraph();  // Drop the previous map's graph
+        return;
+    }
+    PROFILE_SCOPE("nav.build");
+    auto start = std::chrono::steady_clock::now();
+    navGraph.build(*tilemap);
+    navGraphSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    ++navGraphBuilds;
+}
+
+void printNavGraphStats() {
+    if (navGraphBuilds == 0) {
+        return;
+    }
+    std::cout << "Nav graph: " << navGraphBuilds << " builds in " << navGraphSeconds * 1000.0 << " ms, "
+              << navGraph.getNodeCount() << " nodes and " << navGraph.getEdgeCount() << " edges now" << std::endl;
+}
+
+void printWorldStats() {
+    if (!world) {
+        return;
+    }
+    const MazeWorld::Stats& stats = world->getStats();
+    std::cout << "World: chunk " << world->getCenterX() << "," << world->getCenterY() << ", "
+              << world->getChunkCount() << " chunks resident, " << stats.generated << " generated, "
+              << stats.evicted << " evicted, " << stats.shifts << " window moves" << std::endl;
+}
+
+// Paging activity, while the paged map is still up
+void printPageStats() {
+    const TilePages* pages = tilemap->getPages();
+    if (!pages) {
+        return;
+    }
+    const TilePages::Stats& stats = pages->getStats();
+    std::cout << "Pages: " << pages->getResidentPages() << " resident (" << (pages->getBytes() >> 10) << " of "
+              << (pages->getBudget() >> 10) << " KB), " << pages->getPinnedPages() << " pinned, "
+              << stats.pageIns << " paged in, " << stats.evictions << " evicted, " << stats.emptyPages
+              << " empty" << std::endl;
+}
+
+// Next frame of the replay; false once the log is over
+bool nextReplayFrame(InputReplay::Frame& frame) {
+    if (!inputReplay.nextFrame(frame)) {
+        return false;
+    }
+    if (frame.tick != simulationTick && !replayTickWarned) {
+        std::cout << "Warning: Replay is at tick " << simulationTick << ", the recording was at "
+                  << frame.tick << std::endl;
+        replayTickWarned = true;
+    }
+    return true;
+}
+
+// Close the recording, or check the replay against it
+void finishInputLog() {
+    if (inputRecorder.isOpen()) {
+        inputRecorder.close(simulationTick, cameraX, cameraY);
+    }
+    if (inputReplay.isOpen()) {
+        inputReplay.verify(simulationTick, cameraX, cameraY);
+    }
+}
+
+// Key commands that act once per press: map and render mode cycling
+void handleCommands() {
+    // Cycle through different maps with 'n' key; the current map stays up until the
+    // next one has loaded, and pressing again skips a map still loading
+    if (input.keysPressed[SDL_SCANCODE_N] && !worldMode) {
         if (!availableMaps.empty()) {
             currentMapIndex = (currentMapIndex + 1) % availableMaps.size();
-            if (tilemap->loadFromCSV(availableMaps[currentMapIndex])) {
-                // Reset camera to center
-                cameraX = (tilemap->getWidth() * TILE_SIZE - SCREEN_WIDTH) / 2;
-                cameraY = (tilemap->getHeight() * TILE_SIZE - SCREEN_HEIGHT) / 2;
-            }
+            requestMap(availableMaps[currentMapIndex]);
+            prefetchNeighborMaps();
         }
     }
     
+    // Toggle the endless maze world with 'm'
+    if (input.keysPressed[SDL_SCANCODE_M]) {
+        toggleWorld();
+    }
+    
+    // Cycle tile render paths with 'r' to compare them
+    if (input.keysPressed[SDL_SCANCODE_R] && tilemap) {
+        const char* names[] = {"immediate", "chunked", "batched"};
+        int mode = (static_cast<int>(tilemap->getRenderMode()) + 1) % 3;
+        tilemap->setRenderMode(static_cast<RenderMode>(mode));
+        std::cout << "Render mode: " << names[mode] << std::endl;
+    }
+    
+#ifdef CROSSROADS_PROFILING
+    // F3 toggles the profiler overlay, F4 saves a trace of the recent frames
+    if (input.keysPressed[SDL_SCANCODE_F3]) {
+        showProfiler = !showProfiler;
+    }
+    if (input.keysPressed[SDL_SCANCODE_F4]) {
+        profiler.writeTrace(traceFile);
+    }
+#endif
+}
+
+void renderFrame(int renderCameraX, int renderCameraY) {
+    PROFILE_SCOPE("render");
     
     // Clear screen
     SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);  // Black background
     SDL_RenderClear(renderer);
     
+    PROFILE_DRAW_CALLS(1);
+    
     // Render tilemap
     if (tilemap) {
-        tilemap->render(renderer, cameraX, cameraY, SCREEN_WIDTH, SCREEN_HEIGHT);
+        tilemap->render(renderer, renderCameraX, renderCameraY, SCREEN_WIDTH, SCREEN_HEIGHT);
     }
     
     // Render input debug visualization (smaller, in corner)
     SDL_SetRenderDrawColor(renderer, 255, 255, 255, 128);
     SDL_Rect debugBg = {SCREEN_WIDTH - 120, 10, 110, 60};
     SDL_RenderFillRect(renderer, &debugBg);
+    PROFILE_DRAW_CALLS(1);
     
     // Show movement as small indicator
     if (input.moveX != 0.0f || input.moveY != 0.0f) {
@@ -96,19 +387,345 @@ void gameLoop() {
         int offsetY = (int)(input.moveY * 20);
         SDL_Rect moveRect = {centerX + offsetX - 3, centerY + offsetY - 3, 6, 6};
         SDL_RenderFillRect(renderer, &moveRect);
+        PROFILE_DRAW_CALLS(1);
     }
     
-    SDL_RenderPresent(renderer);
+#ifdef CROSSROADS_PROFILING
+    if (showProfiler) {
+        profiler.renderOverlay(renderer, 4, 4);
+    }
+#endif
     
-#ifndef __EMSCRIPTEN__
-    // Only exit in native builds; web version handles this differently
+    {
+        PROFILE_SCOPE("present");
+        SDL_RenderPresent(renderer);
+    }
+}
+
+void gameLoop() {
+    const double frameSeconds = pacer.beginFrame();
+    PROFILE_END_FRAME();  // Close the previous frame's profile
+    PROFILE_SCOPE("frame");
+    
+    // A replay takes this frame's input and tick count from the log
+    const bool replaying = inputReplay.isOpen();
+    InputReplay::Frame replayFrame;
+    if (replaying && !nextReplayFrame(replayFrame)) {
+        running = false;
+    }
+    
+    const bool mapSwapped = (!replaying || replayFrame.mapSwapped) && swapLoadedMap(replaying);
+    
+    // Reset per-frame input state
+    input.reset();
+    
+    // Handle events
+    {
+        PROFILE_SCOPE("events");
+        SDL_Event e;
+        while (SDL_PollEvent(&e)) {
+            if (e.type == SDL_QUIT) {
+                running = false;
+            }
+            
+            // Special case: ESC to quit (useful for web version)
+            if (e.type == SDL_KEYDOWN && e.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
+                running = false;
+            }
+            
+            // Cached map chunks lose their contents (or textures) when the renderer resets
+            if (e.type == SDL_RENDER_TARGETS_RESET && tilemap) {
+                tilemap->invalidateRenderCache();
+            }
+            if (e.type == SDL_RENDER_DEVICE_RESET && tilemap) {
+                tilemap->releaseRenderCache();
+            }
+            
+            // While replaying, live input only quits
+            if (replaying) {
+                continue;
+            }
+            const bool padWasConnected = input.gamepadConnected;
+            handleEvent(e);
+            
+            // Pads coming and going only reach the log when they change the active pad:
+            // a replay cannot tell which pad an event was for
+            const bool padEvent = e.type == SDL_CONTROLLERDEVICEADDED || e.type == SDL_CONTROLLERDEVICEREMOVED;
+            if (!padEvent || input.gamepadConnected != padWasConnected) {
+                inputRecorder.record(e);
+            }
+        }
+        
+        for (SDL_Event& recorded : replayFrame.events) {
+            handleReplayedEvent(recorded);
+        }
+    }
+    
+    // Update virtual input state
+    {
+        PROFILE_SCOPE("input");
+        updateVirtualInput();
+    }
+    
+    handleCommands();
+    
+    // Advance the simulation by whole ticks of real time
+    const uint32_t frameTick = simulationTick;
+    int ticks = replaying ? replayFrame.ticks : timestep.advance(frameSeconds);
+    for (int i = 0; i < ticks; ++i) {
+        PROFILE_SCOPE("simulate");
+        simulate();
+    }
+    inputRecorder.endFrame(frameTick, ticks, mapSwapped);
+    updateNavGraph();
+    
+    // Draw between the last two ticks so motion stays smooth at any display rate
+    // (replays draw the latest tick: their ticks follow the log, not the clock)
+    const float alpha = replaying ? 1.0f : static_cast<float>(timestep.getAlpha());
+    int renderCameraX = static_cast<int>(std::lround(previousCameraX + (cameraX - previousCameraX) * alpha));
+    int renderCameraY = static_cast<int>(std::lround(previousCameraY + (cameraY - previousCameraY) * alpha));
+    renderFrame(renderCameraX, renderCameraY);
+    
+#ifdef __EMSCRIPTEN__
+    // Native builds leave the loop in main(); the browser loop has to be cancelled
     if (!running) {
-        exit(0);
+        pacer.getStats().print();
+        finishInputLog();
+        if (traceOnExit) {
+            profiler.writeTrace(traceFile);
+        }
+        emscripten_cancel_main_loop();
     }
 #endif
 }
 
+// Headless run: the game logic without a window, as fast as it goes
+struct HeadlessOptions {
+    long ticks = 36000;   // 10 minutes of game time
+    int mapEvery = 600;   // Ticks between map switches (0 = never)
+    bool render = false;  // Also draw each tick into an offscreen software renderer
+};
+
+// Deterministic stand-in for a player: walk the camera around and switch maps
+void scriptInput(long tick, const HeadlessOptions& options) {
+    static const SDL_Scancode pattern[8][2] = {
+        {SDL_SCANCODE_D, SDL_SCANCODE_UNKNOWN}, {SDL_SCANCODE_D, SDL_SCANCODE_S},
+        {SDL_SCANCODE_S, SDL_SCANCODE_UNKNOWN}, {SDL_SCANCODE_A, SDL_SCANCODE_S},
+        {SDL_SCANCODE_A, SDL_SCANCODE_UNKNOWN}, {SDL_SCANCODE_A, SDL_SCANCODE_W},
+        {SDL_SCANCODE_W, SDL_SCANCODE_UNKNOWN}, {SDL_SCANCODE_D, SDL_SCANCODE_W}};
+    
+    input.keys.fill(false);
+    
+    // The world has no edges: head east-southeast so a long run keeps reaching new chunks
+    const SDL_Scancode* held = pattern[(tick / 90) % (worldMode ? 2 : 8)];
+    input.keys[held[0]] = true;
+    input.keys[held[1]] = held[1] != SDL_SCANCODE_UNKNOWN;
+    
+    if (options.mapEvery > 0 && tick > 0 && tick % options.mapEvery == 0) {
+        input.keys[SDL_SCANCODE_N] = true;
+        input.keysPressed[SDL_SCANCODE_N] = true;
+    }
+}
+
+int runHeadless(const HeadlessOptions& options) {
+    if (SDL_Init(0) < 0) {
+        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+    
+    SDL_Surface* surface = nullptr;
+    if (options.render) {
+        surface = SDL_CreateRGBSurfaceWithFormat(0, SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_PIXELFORMAT_ARGB8888);
+        renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+        if (!renderer) {
+            std::cerr << "Software renderer creation failed: " << SDL_GetError() << std::endl;
+            SDL_FreeSurface(surface);
+            SDL_Quit();
+            return 1;
+        }
+    }
+    
+    tilemap = new Tilemap(50, 30);
+    if (renderer) {
+        tilemap->createDefaultTexture(renderer);
+    }
+    loadFirstMap();
+    
+    // A replay supplies the input and the run length instead of the script
+    const bool replaying = inputReplay.isOpen();
+    if (replaying) {
+        input.gamepadConnected = inputReplay.getSession().gamepadConnected;
+    }
+    if (startInWorld) {
+        toggleWorld();
+    }
+    InputReplay::Frame replayFrame;
+    
+    ThreadPool pool(MAP_PREFETCH_THREADS);
+    prefetchPool = &pool;
+    prefetchNeighborMaps();
+    
+    // Wall time per subsystem
+    const char* names[] = {"input", "commands", "simulation", "render"};
+    double seconds[4] = {0.0, 0.0, 0.0, 0.0};
+    auto timed = [&](int subsystem, auto&& work) {
+        auto start = std::chrono::steady_clock::now();
+        work();
+        seconds[subsystem] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+    
+    // One recorded frame per step when replaying, else one scripted tick
+    auto start = std::chrono::steady_clock::now();
+    long tick = 0;
+    while (replaying ? nextReplayFrame(replayFrame) : tick < options.ticks) {
+        timed(0, [&] {
+            input.reset();
+            if (replaying) {
+                for (SDL_Event& recorded : replayFrame.events) {
+                    handleReplayedEvent(recorded);
+                }
+            } else {
+                scriptInput(tick, options);
+            }
+            updateVirtualInput();
+        });
+        timed(1, [&] {
+            // Always wait for the load: swaps must land on the same tick every run
+            if (!replaying || replayFrame.mapSwapped) {
+                swapLoadedMap(true);
+            }
+            handleCommands();
+        });
+        const int ticks = replaying ? replayFrame.ticks : 1;
+        timed(2, [&] {
+            for (int i = 0; i < ticks; ++i) {
+                simulate();
+            }
+            updateNavGraph();
+        });
+        tick += ticks;
+        if (renderer) {
+            timed(3, [] { renderFrame(static_cast<int>(cameraX), static_cast<int>(cameraY)); });
+        }
+        PROFILE_END_FRAME();
+    }
+    double total = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    
+    std::cout << "Headless: " << tick << " ticks in " << total << " s ("
+              << (total > 0.0 ? tick / total : 0.0) << " ticks/sec)" << std::endl;
+    for (int i = 0; i < 4; ++i) {
+        if (i == 3 && !renderer) continue;
+        std::cout << "  " << names[i] << ": " << seconds[i] * 1000.0 << " ms ("
+                  << seconds[i] * 1e6 / std::max(1L, tick) << " us/tick)" << std::endl;
+    }
+    
+    finishInputLog();
+    if (traceOnExit) {
+        profiler.writeTrace(traceFile);
+    }
+    
+    printMapCacheStats();
+    printWorldStats();
+    printPageStats();
+    printNavGraphStats();
+    mapLoader.cancel();
+    prefetchPool = nullptr;
+    delete world;
+    delete tilemap;
+    if (renderer) {
+        SDL_DestroyRenderer(renderer);
+        SDL_FreeSurface(surface);
+    }
+    SDL_Quit();
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
+    // --no-vsync paces frames with timed sleeps instead of the display.
+    // --headless [--ticks N] [--map-every N] [--render] runs without a window.
+    // --map-cache-mb N sets the parsed map cache budget (default 64).
+    // --map-filter TEXT and --map-sort name|size choose and order the maps N cycles through.
+    // --trace FILE saves a profiler trace on exit (CROSSROADS_PROFILING builds).
+    // --record FILE logs the session's input; --replay FILE plays one back, windowed or headless.
+    // --world starts in the endless maze world, --world-seed N picks it (default 1).
+    // --paged-map NAME shows a binary map paged in on demand, within --page-budget-mb N (default 64).
+    bool vsync = true;
+    bool headless = false;
+    HeadlessOptions headlessOptions;
+    const char* recordFile = nullptr;
+    const char* replayFile = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--no-vsync") == 0) {
+            vsync = false;
+        } else if (std::strcmp(argv[i], "--headless") == 0) {
+            headless = true;
+        } else if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            headlessOptions.ticks = std::atol(argv[++i]);
+        } else if (std::strcmp(argv[i], "--map-every") == 0 && i + 1 < argc) {
+            headlessOptions.mapEvery = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--render") == 0) {
+            headlessOptions.render = true;
+        } else if (std::strcmp(argv[i], "--map-cache-mb") == 0 && i + 1 < argc) {
+            mapCache.setBudget(static_cast<size_t>(std::max(0, std::atoi(argv[++i]))) << 20);
+        } else if (std::strcmp(argv[i], "--map-filter") == 0 && i + 1 < argc) {
+            mapFilter = argv[++i];
+        } else if (std::strcmp(argv[i], "--map-sort") == 0 && i + 1 < argc) {
+            sortMapsBySize = std::strcmp(argv[++i], "size") == 0;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            traceFile = argv[++i];
+            traceOnExit = true;
+        } else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayFile = argv[++i];
+        } else if (std::strcmp(argv[i], "--world") == 0) {
+            startInWorld = true;
+        } else if (std::strcmp(argv[i], "--world-seed") == 0 && i + 1 < argc) {
+            worldSeed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--paged-map") == 0 && i + 1 < argc) {
+            pagedMap = argv[++i];
+        } else if (std::strcmp(argv[i], "--page-budget-mb") == 0 && i + 1 < argc) {
+            pageBudget = static_cast<size_t>(std::max(0, std::atoi(argv[++i]))) << 20;
+        }
+    }
+    
+#ifndef CROSSROADS_PROFILING
+    if (traceOnExit) {
+        std::cout << "Warning: --trace needs a build with CROSSROADS_PROFILING" << std::endl;
+        traceOnExit = false;
+    }
+#endif
+    
+    if (replayFile) {
+        if (!inputReplay.open(replayFile)) {
+            return 1;
+        }
+        if (inputReplay.getSession().tickRate != static_cast<uint32_t>(TICK_RATE)) {
+            std::cout << "Warning: Input log was recorded at " << inputReplay.getSession().tickRate
+                      << " Hz, simulating at " << TICK_RATE << " Hz" << std::endl;
+        }
+        if (recordFile) {
+            std::cout << "Warning: --record is ignored while replaying" << std::endl;
+            recordFile = nullptr;
+        }
+        
+        // Logs from before the world existed have no seed
+        const InputSession& session = inputReplay.getSession();
+        startInWorld = session.worldMode;
+        worldSeed = session.worldSeed != 0 ? session.worldSeed : worldSeed;
+        if (!pagedMap.empty() && pagedMap != session.pagedMap) {
+            std::cout << "Warning: --paged-map is ignored while replaying; using the recorded map" << std::endl;
+        }
+        pagedMap = session.pagedMap;
+    }
+    
+    if (headless) {
+        if (recordFile) {
+            std::cout << "Warning: --record is ignored in headless runs (their input is scripted)" << std::endl;
+        }
+        return runHeadless(headlessOptions);
+    }
+    
     // Initialize SDL with video and game controller support
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_GAMECONTROLLER) < 0) {
         std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
@@ -127,7 +744,8 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
-    renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+    Uint32 rendererFlags = SDL_RENDERER_ACCELERATED | (vsync ? SDL_RENDERER_PRESENTVSYNC : 0);
+    renderer = SDL_CreateRenderer(window, -1, rendererFlags);
     
     if (!renderer) {
         std::cerr << "Renderer creation failed: " << SDL_GetError() << std::endl;
@@ -136,6 +754,18 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    // Use vsync only if the renderer actually got it
+    SDL_RendererInfo rendererInfo;
+    SDL_DisplayMode displayMode;
+    bool hasVsync = SDL_GetRendererInfo(renderer, &rendererInfo) == 0 &&
+                    (rendererInfo.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+    double refreshRate = SDL_GetWindowDisplayMode(window, &displayMode) == 0 && displayMode.refresh_rate > 0
+                             ? displayMode.refresh_rate : TICK_RATE;
+#ifdef __EMSCRIPTEN__
+    hasVsync = true;  // requestAnimationFrame paces the browser loop
+#endif
+    pacer.setVsync(hasVsync, refreshRate);
+    
     // Initialize gamepad support
     initializeGamepad();
     
@@ -144,42 +774,79 @@ int main(int argc, char* argv[]) {
     tilemap->createDefaultTexture(renderer);
     
     // Load available maps and set initial map
-    availableMaps = tilemap->getAvailableMaps();
-    if (!availableMaps.empty()) {
-        tilemap->loadFromCSV(availableMaps[0]);
-    } else {
-        std::cout << "Warning: No CSV maps found, using test pattern" << std::endl;
-        tilemap->generateTestMap();
+    loadFirstMap();
+    
+    // Start the input log from the state the game starts in
+    if (inputReplay.isOpen()) {
+        input.gamepadConnected = inputReplay.getSession().gamepadConnected;
+    } else if (recordFile) {
+        InputSession session;
+        session.tickRate = static_cast<uint32_t>(TICK_RATE);
+        session.gamepadConnected = input.gamepadConnected;
+        session.maps = availableMaps;
+        session.worldMode = startInWorld;
+        session.worldSeed = worldSeed;
+        session.pagedMap = !pagedMap.empty() && currentPagedMap == pagedMap ? pagedMap : std::string();
+        inputRecorder.open(recordFile, session);
+    }
+    if (startInWorld) {
+        toggleWorld();
     }
     
-    // Center camera initially
-    cameraX = (tilemap->getWidth() * TILE_SIZE - SCREEN_WIDTH) / 2;
-    cameraY = (tilemap->getHeight() * TILE_SIZE - SCREEN_HEIGHT) / 2;
+    // Start parsing the next maps (browser builds have no threads: parse on first visit)
+#ifndef __EMSCRIPTEN__
+    ThreadPool pool(MAP_PREFETCH_THREADS);
+    prefetchPool = &pool;
+    prefetchNeighborMaps();
+#endif
     
     std::cout << "=== Crossroads Maze Generator ===" << std::endl;
     std::cout << "Controls:" << std::endl;
     std::cout << "  Movement: WASD, Arrow Keys (camera movement)" << std::endl;
     std::cout << "  N: Cycle through available maps" << std::endl;
+    std::cout << "  M: Toggle the endless maze world" << std::endl;
+    std::cout << "  R: Cycle tile render mode (immediate, chunked, batched)" << std::endl;
+#ifdef CROSSROADS_PROFILING
+    std::cout << "  F3: Toggle profiler overlay, F4: Save trace to " << traceFile << std::endl;
+#endif
     std::cout << "  Quit: ESC" << std::endl;
+    std::cout << "Frame pacing: " << (hasVsync ? "vsync" : "timed sleep") << ", simulation at "
+              << TICK_RATE << " Hz" << std::endl;
     std::cout << "Map size: " << tilemap->getWidth() << "x" << tilemap->getHeight() << " tiles" << std::endl;
     
     if (!availableMaps.empty()) {
-        std::cout << "Found " << availableMaps.size() << " CSV maps" << std::endl;
-        std::cout << "Current map: " << availableMaps[currentMapIndex] << std::endl;
+        std::cout << "Found " << availableMaps.size() << " maps" << std::endl;
+        std::cout << "Current map: " << (tilemap->isPaged() ? currentPagedMap + " (paged)" : availableMaps[currentMapIndex])
+                  << std::endl;
     } else {
-        std::cout << "No CSV maps found, using generated maze" << std::endl;
+        std::cout << "No maps found, using generated maze" << std::endl;
     }
     
 #ifdef __EMSCRIPTEN__
-    emscripten_set_main_loop(gameLoop, 60, 1);
+    emscripten_set_main_loop(gameLoop, 0, 1);
 #else
     while (running) {
         gameLoop();
-        SDL_Delay(16); // ~60 FPS
+        pacer.waitForNextFrame();
+    }
+    
+    pacer.getStats().print();
+    finishInputLog();
+    std::cout << "Simulation: " << timestep.getTickCount() << " ticks, "
+              << timestep.getDroppedTicks() << " dropped" << std::endl;
+    if (traceOnExit) {
+        profiler.writeTrace(traceFile);
     }
+    printMapCacheStats();
+    printWorldStats();
+    printPageStats();
+    printNavGraphStats();
 #endif
     
     // Cleanup
+    mapLoader.cancel();
+    prefetchPool = nullptr;
+    delete world;
     delete tilemap;
     if (input.gamepad) {
         SDL_GameControllerClose(input.gamepad);
@@ -0,0 +1,122 @@
+#include "map_cache.h"
+
+void MapCache::setBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    budget_ = bytes;
+    evictDownTo(budget_);
+}
+
+size_t MapCache::getBudget() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return budget_;
+}
+
+size_t MapCache::getBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return bytes_;
+}
+
+size_t MapCache::getCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return entries_.size();
+}
+
+MapCache::Stats MapCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+std::shared_ptr<const TileBuffer> MapCache::load(const std::string& filename) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto found = index_.find(filename);
+        if (found != index_.end()) {
+            entries_.splice(entries_.begin(), entries_, found->second);
+            ++stats_.hits;
+            return found->second->map;
+        }
+        ++stats_.misses;
+    }
+
+    // Parse outside the lock so other maps stay available meanwhile
+    auto map = std::make_shared<TileBuffer>();
+    if (!map->load(filename)) {
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    insert(filename, map, true);
+    return map;
+}
+
+void MapCache::prefetch(const std::vector<std::string>& filenames, ThreadPool& pool) {
+    for (const std::string& filename : filenames) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (budget_ == 0 || index_.count(filename) || !prefetching_.insert(filename).second) {
+                continue;
+            }
+        }
+
+        pool.submit([this, filename] {
+            // A map too big for the free budget would be parsed only to be dropped
+            int width = 0;
+            int height = 0;
+            bool fits = MapFormat::readSize("assets/maps/" + filename, width, height);
+            if (fits) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                fits = bytes_ <= budget_ && TileBuffer::bytesFor(width, height) <= budget_ - bytes_;
+            }
+
+            auto map = std::make_shared<TileBuffer>();
+            const bool loaded = fits && map->load(filename);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            prefetching_.erase(filename);
+            if (loaded && !index_.count(filename) && insert(filename, map, false)) {
+                ++stats_.prefetched;
+            }
+        });
+    }
+}
+
+void MapCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    bytes_ = 0;
+}
+
+size_t MapCache::sizeOf(const TileBuffer& map) {
+    return map.types.capacity() + map.variants.capacity() + map.solid.capacity() * sizeof(uint64_t);
+}
+
+bool MapCache::insert(const std::string& filename, std::shared_ptr<const TileBuffer> map, bool evict) {
+    const size_t bytes = sizeOf(*map);
+    if (bytes > budget_ || (!evict && bytes_ + bytes > budget_)) {
+        return false;
+    }
+
+    // Another thread may have cached the same map meanwhile; keep the newer copy
+    auto found = index_.find(filename);
+    if (found != index_.end()) {
+        bytes_ -= found->second->bytes;
+        entries_.erase(found->second);
+        index_.erase(found);
+    }
+
+    evictDownTo(budget_ - bytes);
+    entries_.push_front({filename, std::move(map), bytes});
+    index_[filename] = entries_.begin();
+    bytes_ += bytes;
+    return true;
+}
+
+void MapCache::evictDownTo(size_t bytes) {
+    while (bytes_ > bytes && !entries_.empty()) {
+        bytes_ -= entries_.back().bytes;
+        index_.erase(entries_.back().filename);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+}
\ No newline at end of file
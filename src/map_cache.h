@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "thread_pool.h"
+#include "tilemap.h"
+
+// Parsed maps kept in memory, so returning to a map copies its planes instead of
+// parsing the file again. Entries are evicted least recently used first once the
+// total size passes the byte budget. Thread-safe: the map loader and prefetch
+// tasks share one cache.
+class MapCache {
+public:
+    static constexpr size_t DEFAULT_BUDGET = size_t(64) << 20;
+
+    struct Stats {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t prefetched = 0;  // Maps parsed ahead of use
+    };
+
+    explicit MapCache(size_t budgetBytes = DEFAULT_BUDGET) : budget_(budgetBytes) {}
+
+    // Evicts down to the new budget
+    void setBudget(size_t bytes);
+    size_t getBudget() const;
+    size_t getBytes() const;
+    size_t getCount() const;
+    Stats getStats() const;
+
+    // The parsed map (filename relative to assets/maps), parsing and caching it on a
+    // miss; nullptr if it does not load. Maps larger than the whole budget are
+    // returned without being cached.
+    std::shared_ptr<const TileBuffer> load(const std::string& filename);
+
+    // Parse the maps on pool in the background. Prefetched maps only use free budget:
+    // they never evict anything, so the nearest maps should come first. Maps whose
+    // header says they cannot fit are skipped before parsing. The cache must outlive
+    // the pool's pending tasks.
+    void prefetch(const std::vector<std::string>& filenames, ThreadPool& pool);
+
+    void clear();
+
+private:
+    struct Entry {
+        std::string filename;
+        std::shared_ptr<const TileBuffer> map;
+        size_t bytes;
+    };
+
+    size_t budget_;
+    size_t bytes_ = 0;
+    std::list<Entry> entries_;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+    std::unordered_set<std::string> prefetching_;  // Queued or being parsed by prefetch()
+    Stats stats_;
+    mutable std::mutex mutex_;
+
+    static size_t sizeOf(const TileBuffer& map);
+    bool insert(const std::string& filename, std::shared_ptr<const TileBuffer> map, bool evict);
+    void evictDownTo(size_t bytes);
+};
\ No newline at end of file
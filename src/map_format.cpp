@@ -0,0 +1,499 @@
+#include "map_format.h"
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <charconv>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = {'C', 'R', 'M', 'P'};
+    const uint64_t PAYLOAD_ALIGNMENT = 16;
+}
+
+void MapData::resetSolidTypes() {
+    for (int i = 0; i < 256; ++i) {
+        solidTypes[i] = isSolidTileType(static_cast<TileType>(i));
+    }
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* mapping = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data_ = static_cast<const uint8_t*>(mapping);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+
+    if (mapped_ || size_ == 0) {
+        open_ = true;
+        return true;
+    }
+#endif
+
+    // Fallback: read the whole file into memory
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        size_ = 0;
+        return false;
+    }
+
+    size_ = static_cast<size_t>(file.tellg());
+    buffer_.resize(size_);
+    file.seekg(0);
+    if (size_ > 0 && !file.read(reinterpret_cast<char*>(buffer_.data()), size_)) {
+        buffer_.clear();
+        size_ = 0;
+        return false;
+    }
+
+    data_ = buffer_.data();
+    open_ = true;
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (mapped_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    buffer_.clear();
+    buffer_.shrink_to_fit();
+    data_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    open_ = false;
+}
+
+void MapFormat::View::solidTypes(std::array<bool, 256>& solid) const {
+    for (int i = 0; i < 256; ++i) {
+        solid[i] = isSolidTileType(static_cast<TileType>(i));
+    }
+    for (uint32_t i = 0; i < header->tileTypeCount; ++i) {
+        solid[tileTypes[i].type] = (tileTypes[i].flags & TILE_SOLID) != 0;
+    }
+}
+
+bool MapFormat::writeBinary(const std::string& path, const MapData& map) {
+    const size_t cellCount = static_cast<size_t>(map.width) * map.height;
+    if (map.width <= 0 || map.height <= 0 || map.types.size() != cellCount ||
+        (!map.variants.empty() && map.variants.size() != cellCount)) {
+        std::cout << "Error: Invalid map data for binary export: " << path << std::endl;
+        return false;
+    }
+
+    // Tile-type table: every type that appears in the map
+    bool used[256] = {false};
+    for (uint8_t type : map.types) {
+        used[type] = true;
+    }
+
+    std::vector<MapTileInfo> tileTypes;
+    for (int i = 0; i < 256; ++i) {
+        if (used[i]) {
+            tileTypes.push_back({static_cast<uint8_t>(i), map.solidTypes[i] ? TILE_SOLID : uint8_t(0)});
+        }
+    }
+
+    MapFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(MapFileHeader);
+    header.width = map.width;
+    header.height = map.height;
+    header.flags = map.variants.empty() ? 0 : FLAG_VARIANTS;
+    header.tileTypeCount = static_cast<uint32_t>(tileTypes.size());
+
+    uint64_t tableEnd = sizeof(MapFileHeader) + tileTypes.size() * sizeof(MapTileInfo);
+    header.payloadOffset = (tableEnd + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+    header.payloadSize = cellCount * (map.variants.empty() ? 1 : 2);
+    header.checksum = checksum(map.types.data(), cellCount);
+    if (!map.variants.empty()) {
+        header.checksum = checksum(map.variants.data(), cellCount, header.checksum);
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cout << "Error: Could not create map file: " << path << std::endl;
+        return false;
+    }
+
+    const char padding[PAYLOAD_ALIGNMENT] = {0};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(tileTypes.data()), tileTypes.size() * sizeof(MapTileInfo));
+    file.write(padding, header.payloadOffset - tableEnd);
+    file.write(reinterpret_cast<const char*>(map.types.data()), cellCount);
+    if (!map.variants.empty()) {
+        file.write(reinterpret_cast<const char*>(map.variants.data()), cellCount);
+    }
+
+    if (!file) {
+        std::cout << "Error: Failed writing map file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MapFormat::viewBinary(const MappedFile& file, const std::string& path, View& view, bool verify) {
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+
+    if (size < sizeof(MapFileHeader) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cout << "Error: Not a binary map file: " << path << std::endl;
+        return false;
+    }
+
+    const MapFileHeader* header = reinterpret_cast<const MapFileHeader*>(data);
+    if (header->version != VERSION || header->headerSize != sizeof(MapFileHeader)) {
+        std::cout << "Error: Unsupported binary map version " << header->version << ": " << path << std::endl;
+        return false;
+    }
+
+    const uint64_t cellCount = static_cast<uint64_t>(header->width) * header->height;
+    const uint64_t planes = (header->flags & FLAG_VARIANTS) ? 2 : 1;
+    const uint64_t tableEnd = sizeof(MapFileHeader) + uint64_t(header->tileTypeCount) * sizeof(MapTileInfo);
+    // Each part checked against size on its own, so a crafted offset cannot wrap the sum
+    if (header->width == 0 || header->height == 0 || header->width > INT32_MAX || header->height > INT32_MAX ||
+        header->tileTypeCount > 256 || tableEnd > size || header->payloadOffset < tableEnd ||
+        header->payloadOffset > size || header->payloadSize != cellCount * planes ||
+        header->payloadSize > size - header->payloadOffset) {
+        std::cout << "Error: Corrupt binary map header: " << path << std::endl;
+        return false;
+    }
+
+    const uint8_t* payload = data + header->payloadOffset;
+    if (verify && checksum(payload, header->payloadSize) != header->checksum) {
+        std::cout << "Error: Checksum mismatch in binary map: " << path << std::endl;
+        return false;
+    }
+
+    view.header = header;
+    view.tileTypes = reinterpret_cast<const MapTileInfo*>(data + sizeof(MapFileHeader));
+    view.types = payload;
+    view.variants = planes == 2 ? payload + cellCount : nullptr;
+    view.width = static_cast<int>(header->width);
+    view.height = static_cast<int>(header->height);
+    return true;
+}
+
+bool MapFormat::readBinary(const std::string& path, MapData& map) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Error: Could not open map file: " << path << std::endl;
+        return false;
+    }
+
+    View view;
+    if (!viewBinary(file, path, view)) {
+        return false;
+    }
+
+    const size_t cellCount = static_cast<size_t>(view.width) * view.height;
+    map.width = view.width;
+    map.height = view.height;
+    map.types.assign(view.types, view.types + cellCount);
+    if (view.variants) {
+        map.variants.assign(view.variants, view.variants + cellCount);
+    } else {
+        map.variants.clear();
+    }
+    view.solidTypes(map.solidTypes);
+    return true;
+}
+
+namespace {
+    // Cursor over a CSV buffer that tracks the line for error messages
+    struct CSVCursor {
+        const char* pos;
+        const char* end;
+        int line = 1;
+
+        void skipBlanks() {
+            while (pos < end && (*pos == ' ' || *pos == '\t')) ++pos;
+        }
+
+        // Consume an optional "\r" and the "\n" ending the current line
+        bool endLine() {
+            skipBlanks();
+            if (pos < end && *pos == '\r') ++pos;
+            if (pos == end) return true;
+            if (*pos != '\n') return false;
+            ++pos;
+            ++line;
+            return true;
+        }
+
+        bool readInt(int& value) {
+            skipBlanks();
+            auto result = std::from_chars(pos, end, value);
+            if (result.ec != std::errc()) return false;
+            pos = result.ptr;
+            skipBlanks();
+            return true;
+        }
+
+        bool atLineEnd() const {
+            return pos == end || *pos == '\n' || *pos == '\r';
+        }
+    };
+}
+
+bool MapFormat::readCSV(const std::string& path, MapData& map) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Error: Could not open map file: " << path << std::endl;
+        return false;
+    }
+
+    if (file.size() == 0) {
+        std::cout << "Error: Empty map file: " << path << std::endl;
+        return false;
+    }
+
+    CSVCursor in{reinterpret_cast<const char*>(file.data()), reinterpret_cast<const char*>(file.data()) + file.size()};
+
+    // Read dimensions from first line
+    int width = 0;
+    int height = 0;
+    if (!in.readInt(width) || in.pos == in.end || *in.pos++ != ',' || !in.readInt(height) ||
+        width <= 0 || height <= 0 || !in.endLine()) {
+        std::cout << "Error: Invalid dimensions in map file: " << path << ":1" << std::endl;
+        return false;
+    }
+
+    map.width = width;
+    map.height = height;
+    map.types.resize(static_cast<size_t>(width) * height);
+    map.variants.clear();
+    map.resetSolidTypes();
+
+    // Read tile data
+    uint8_t* out = map.types.data();
+    for (int row = 0; row < height; ++row) {
+        if (in.pos == in.end) {
+            std::cout << "Error: " << path << ": expected " << height << " rows of tiles, found " << row << std::endl;
+            return false;
+        }
+
+        for (int col = 0; col < width; ++col) {
+            if (col > 0) {
+                if (in.atLineEnd()) {
+                    std::cout << "Error: " << path << ":" << in.line << ": expected " << width
+                              << " tiles, found " << col << std::endl;
+                    return false;
+                }
+                if (*in.pos++ != ',') {
+                    std::cout << "Error: " << path << ":" << in.line << ": expected ',' after tile " << col << std::endl;
+                    return false;
+                }
+            }
+
+            int tileId;
+            if (!in.readInt(tileId)) {
+                std::cout << "Error: " << path << ":" << in.line << ": tile " << col + 1 << " is not a number" << std::endl;
+                return false;
+            }
+            if (tileId < 0 || tileId > 255) {
+                std::cout << "Error: " << path << ":" << in.line << ": tile id " << tileId
+                          << " out of range 0-255" << std::endl;
+                return false;
+            }
+            *out++ = static_cast<uint8_t>(tileId);
+        }
+
+        if (!in.endLine()) {
+            std::cout << "Error: " << path << ":" << in.line << ": more than " << width << " tiles in row" << std::endl;
+            return false;
+        }
+    }
+
+    // Only blank lines may follow the last row
+    while (in.pos < in.end) {
+        if (!in.endLine()) {
+            std::cout << "Error: " << path << ":" << in.line << ": more than " << height << " rows of tiles" << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool MapFormat::readSize(const std::string& path, int& width, int& height) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    if (hasExtension(path, BINARY_EXTENSION)) {
+        MapFileHeader header;
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+            header.width == 0 || header.height == 0 || header.width > INT32_MAX || header.height > INT32_MAX) {
+            return false;
+        }
+        width = static_cast<int>(header.width);
+        height = static_cast<int>(header.height);
+        return true;
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    CSVCursor in{line.data(), line.data() + line.size()};
+    return in.readInt(width) && in.pos != in.end && *in.pos++ == ',' && in.readInt(height) &&
+           width > 0 && height > 0;
+}
+
+uint32_t MapFormat::checksum(const uint8_t* data, size_t size, uint32_t seed) {
+    uint32_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+bool MapFormat::hasExtension(const std::string& filename, const char* extension) {
+    size_t length = std::strlen(extension);
+    return filename.size() >= length && filename.compare(filename.size() - length, length, extension) == 0;
+}
+
+MapRowWriter::~MapRowWriter() {
+    if (file_) {
+        std::fclose(file_);
+    }
+}
+
+bool MapRowWriter::open(const std::string& path, int width, int height, const std::vector<uint8_t>& tileTypes) {
+    if (file_) {
+        std::fclose(file_);
+    }
+    path_ = path;
+    binary_ = MapFormat::hasExtension(path, MapFormat::BINARY_EXTENSION);
+    failed_ = false;
+    width_ = width;
+    height_ = height;
+    rows_ = 0;
+    bytes_ = 0;
+    checksum_ = 2166136261u;
+
+    if (width <= 0 || height <= 0) {
+        std::cout << "Error: Invalid map size for " << path << ": " << width << "x" << height << std::endl;
+        file_ = nullptr;
+        return false;
+    }
+
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cout << "Error: Could not create map file: " << path << std::endl;
+        return false;
+    }
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 20);
+
+    if (!binary_) {
+        char line[32];
+        int length = std::snprintf(line, sizeof(line), "%d,%d\n", width, height);
+        text_.resize(static_cast<size_t>(width) * 4 + 1);
+        return write(line, length);
+    }
+
+    // Same layout as writeBinary(); the checksum is only known once every row is in
+    std::vector<MapTileInfo> table;
+    for (uint8_t type : tileTypes) {
+        table.push_back({type, isSolidTileType(static_cast<TileType>(type)) ? MapFormat::TILE_SOLID : uint8_t(0)});
+    }
+
+    MapFileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = MapFormat::VERSION;
+    header.headerSize = sizeof(MapFileHeader);
+    header.width = width;
+    header.height = height;
+    header.tileTypeCount = static_cast<uint32_t>(table.size());
+
+    const uint64_t tableEnd = sizeof(MapFileHeader) + table.size() * sizeof(MapTileInfo);
+    header.payloadOffset = (tableEnd + PAYLOAD_ALIGNMENT - 1) / PAYLOAD_ALIGNMENT * PAYLOAD_ALIGNMENT;
+    header.payloadSize = static_cast<uint64_t>(width) * height;
+
+    const char padding[PAYLOAD_ALIGNMENT] = {0};
+    return write(&header, sizeof(header)) && write(table.data(), table.size() * sizeof(MapTileInfo)) &&
+           write(padding, header.payloadOffset - tableEnd);
+}
+
+bool MapRowWriter::writeRow(const uint8_t* types) {
+    if (!file_ || failed_ || rows_ == height_) {
+        return false;
+    }
+    ++rows_;
+    checksum_ = MapFormat::checksum(types, width_, checksum_);
+
+    if (binary_) {
+        return write(types, width_);
+    }
+
+    char* p = text_.data();
+    char* end = p + text_.size();
+    for (int x = 0; x < width_; ++x) {
+        if (x > 0) *p++ = ',';
+        p = std::to_chars(p, end, types[x]).ptr;
+    }
+    *p++ = '\n';
+    return write(text_.data(), p - text_.data());
+}
+
+bool MapRowWriter::close() {
+    if (!file_) {
+        return false;
+    }
+
+    bool ok = !failed_ && rows_ == height_;
+    if (ok && binary_) {
+        const long checksumOffset = offsetof(MapFileHeader, checksum);
+        ok = std::fseek(file_, checksumOffset, SEEK_SET) == 0 &&
+             std::fwrite(&checksum_, sizeof(checksum_), 1, file_) == 1;
+    }
+    ok = (std::fclose(file_) == 0) && ok;
+    file_ = nullptr;
+
+    if (!ok) {
+        std::cout << "Error: Failed writing map file: " << path_ << " (" << rows_ << "/" << height_
+                  << " rows)" << std::endl;
+    }
+    return ok;
+}
+
+bool MapRowWriter::write(const void* data, size_t size) {
+    if (std::fwrite(data, 1, size, file_) != size) {
+        failed_ = true;
+    }
+    bytes_ += size;
+    return !failed_;
+}
\ No newline at end of file
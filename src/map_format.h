@@ -0,0 +1,159 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "tile_types.h"
+
+// Map contents independent of SDL, shared by the loaders, the exporters and tools.
+// Planes are row-major with width * height bytes each.
+struct MapData {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> types;
+    std::vector<uint8_t> variants;       // Empty when every variant is 0
+    std::array<bool, 256> solidTypes{};  // Collision flag per tile type
+
+    MapData() { resetSolidTypes(); }
+
+    // Apply the default collision rule from tile_types.h
+    void resetSolidTypes();
+};
+
+// Read-only file contents, memory-mapped when the platform allows it and read
+// into a private buffer otherwise
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    bool isOpen() const { return open_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    bool mapped_ = false;
+    bool open_ = false;
+    std::vector<uint8_t> buffer_;
+};
+
+// Binary map file (.crmap), little endian:
+//   MapFileHeader
+//   MapTileInfo[tileTypeCount]    one entry per tile type used by the map
+//   padding up to payloadOffset   (16-byte aligned)
+//   type plane                    width * height bytes
+//   variant plane                 width * height bytes, only with FLAG_VARIANTS
+// The checksum covers the whole payload (both planes).
+#pragma pack(push, 1)
+struct MapFileHeader {
+    char magic[4];
+    uint16_t version;
+    uint16_t headerSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t flags;
+    uint32_t tileTypeCount;
+    uint64_t payloadOffset;
+    uint64_t payloadSize;
+    uint32_t checksum;
+    uint32_t reserved;
+};
+
+struct MapTileInfo {
+    uint8_t type;
+    uint8_t flags;
+};
+#pragma pack(pop)
+
+class MapFormat {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint32_t FLAG_VARIANTS = 1u << 0;
+    static constexpr uint8_t TILE_SOLID = 1u << 0;
+    static constexpr const char* BINARY_EXTENSION = ".crmap";
+
+    // Validated pointers into a mapped binary map; valid while the MappedFile is open
+    struct View {
+        const MapFileHeader* header = nullptr;
+        const MapTileInfo* tileTypes = nullptr;
+        const uint8_t* types = nullptr;
+        const uint8_t* variants = nullptr;  // nullptr without FLAG_VARIANTS
+        int width = 0;
+        int height = 0;
+
+        // Fill a collision table from the file's tile-type table
+        void solidTypes(std::array<bool, 256>& solid) const;
+    };
+
+    // Binary maps
+    static bool writeBinary(const std::string& path, const MapData& map);
+    static bool readBinary(const std::string& path, MapData& map);
+
+    // Check the header and point view into file. verify = false skips the payload
+    // checksum, which reads the whole file, for callers that only touch parts of it.
+    static bool viewBinary(const MappedFile& file, const std::string& path, View& view, bool verify = true);
+
+    // CSV maps (first line "width,height", then one row of tile ids per line)
+    static bool readCSV(const std::string& path, MapData& map);
+
+    // Dimensions of a binary or CSV map from its header or first line, without
+    // reading the tiles (nor checking them); false if the file is not a map
+    static bool readSize(const std::string& path, int& width, int& height);
+
+    // FNV-1a; pass a previous result as seed to continue a running checksum
+    static uint32_t checksum(const uint8_t* data, size_t size, uint32_t seed = 2166136261u);
+
+    static bool hasExtension(const std::string& filename, const char* extension);
+};
+
+// Writes a map one row of tile types at a time, so generators can stream maps
+// far bigger than memory. The format follows the file extension (.crmap binary,
+// CSV otherwise). Binary files get their checksum patched in by close().
+class MapRowWriter {
+public:
+    MapRowWriter() = default;
+    ~MapRowWriter();
+
+    MapRowWriter(const MapRowWriter&) = delete;
+    MapRowWriter& operator=(const MapRowWriter&) = delete;
+
+    // tileTypes lists every type the rows will use (the binary tile-type table),
+    // with collision from the default rule in tile_types.h
+    bool open(const std::string& path, int width, int height,
+              const std::vector<uint8_t>& tileTypes = {static_cast<uint8_t>(TileType::FLOOR),
+                                                       static_cast<uint8_t>(TileType::WALL_BRICK)});
+
+    // Next row, width tile types
+    bool writeRow(const uint8_t* types);
+
+    // Finish the file; false if it failed or not every row was written
+    bool close();
+
+    uint64_t getBytesWritten() const { return bytes_; }
+    uint32_t getChecksum() const { return checksum_; }
+
+private:
+    bool write(const void* data, size_t size);
+
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    bool binary_ = false;
+    bool failed_ = false;
+    int width_ = 0;
+    int height_ = 0;
+    int rows_ = 0;
+    uint64_t bytes_ = 0;
+    uint32_t checksum_ = 2166136261u;
+    std::vector<char> text_;  // One formatted CSV row
+};
\ No newline at end of file
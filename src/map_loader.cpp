@@ -0,0 +1,109 @@
+#include "map_loader.h"
+#include <utility>
+
+AsyncMapLoader::~AsyncMapLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        ++generation_;
+    }
+    signal_.notify_all();
+
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AsyncMapLoader::request(const std::string& filename) {
+#ifndef __EMSCRIPTEN__
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    pending_ = filename;
+    hasPending_ = true;
+    hasReady_ = false;
+
+    if (!thread_.joinable()) {
+        thread_ = std::thread(&AsyncMapLoader::workerLoop, this);
+    }
+    signal_.notify_one();
+#else
+    // No threads: load now, swap at the next frame boundary like native builds
+    ++generation_;
+    hasReady_ = loadStaging(filename);
+    if (hasReady_) {
+        std::swap(staging_, ready_);
+        readyName_ = filename;
+    }
+#endif
+}
+
+void AsyncMapLoader::cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++generation_;
+    hasPending_ = false;
+    hasReady_ = false;
+}
+
+bool AsyncMapLoader::isLoading() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return hasPending_ || working_ || hasReady_;
+}
+
+void AsyncMapLoader::wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait(lock, [this] { return !hasPending_ && !working_; });
+}
+
+bool AsyncMapLoader::poll(Tilemap& tilemap, std::string& loaded) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!hasReady_) {
+        return false;
+    }
+
+    // The previous planes go back into ready_ and get reused by a later load
+    tilemap.swapBuffer(ready_);
+    loaded = readyName_;
+    hasReady_ = false;
+    return true;
+}
+
+void AsyncMapLoader::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        signal_.wait(lock, [this] { return stopping_ || hasPending_; });
+        if (stopping_) {
+            return;
+        }
+
+        const std::string filename = pending_;
+        const uint64_t generation = generation_;
+        hasPending_ = false;
+        working_ = true;
+
+        lock.unlock();
+        const bool loaded = loadStaging(filename);
+        lock.lock();
+
+        working_ = false;
+        if (loaded && generation == generation_) {
+            std::swap(staging_, ready_);
+            readyName_ = filename;
+            hasReady_ = true;
+        }
+        finished_.notify_all();
+    }
+}
+
+bool AsyncMapLoader::loadStaging(const std::string& filename) {
+    if (!cache_) {
+        return staging_.load(filename);
+    }
+
+    // Copy the cached planes; the copy reuses staging_'s allocations
+    std::shared_ptr<const TileBuffer> map = cache_->load(filename);
+    if (!map) {
+        return false;
+    }
+    staging_ = *map;
+    return true;
+}
\ No newline at end of file
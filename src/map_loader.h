@@ -0,0 +1,65 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "map_cache.h"
+#include "tilemap.h"
+
+// Loads maps on a background thread so switching maps never stalls a frame.
+// The worker parses into a staging TileBuffer; poll() swaps a finished map into
+// the live Tilemap at a frame boundary, and the old map stays on screen until
+// then. A new request() supersedes the one in flight: that result is dropped
+// rather than shown, and a request that has not started yet is replaced.
+// With a MapCache, parsed maps come from (and go into) the cache, so a cached map
+// costs one copy of its planes. Builds without thread support (Emscripten) load
+// inside request() and still swap at the next poll().
+class AsyncMapLoader {
+public:
+    explicit AsyncMapLoader(MapCache* cache = nullptr) : cache_(cache) {}
+    ~AsyncMapLoader();
+
+    AsyncMapLoader(const AsyncMapLoader&) = delete;
+    AsyncMapLoader& operator=(const AsyncMapLoader&) = delete;
+
+    // Start loading filename (relative to assets/maps)
+    void request(const std::string& filename);
+
+    // Drop the pending request and any result not yet swapped in
+    void cancel();
+
+    // A requested map has not been swapped in yet
+    bool isLoading() const;
+
+    // Block until the requested map has finished loading (or failed); replays use
+    // this to swap maps on the same frame as the recording
+    void wait();
+
+    // Main thread, between frames: swap the finished map into tilemap. Returns true
+    // and the map's file name if that happened.
+    bool poll(Tilemap& tilemap, std::string& loaded);
+
+private:
+    void workerLoop();
+    bool loadStaging(const std::string& filename);
+
+    MapCache* cache_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable signal_;
+    std::condition_variable finished_;  // A load completed
+    std::thread thread_;  // Started by the first request()
+    bool stopping_ = false;
+
+    uint64_t generation_ = 0;  // Bumped by every request() and cancel()
+    std::string pending_;      // Request the worker has not picked up yet
+    bool hasPending_ = false;
+    bool working_ = false;
+
+    TileBuffer staging_;       // Worker-owned while working_
+    TileBuffer ready_;         // Finished map waiting for poll()
+    std::string readyName_;
+    bool hasReady_ = false;
+};
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include "map_manifest.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char MAGIC[4] = {'C', 'R', 'M', 'I'};
+    const uint32_t FLAG_GENERATED = 1u << 0;
+    const uint32_t FLAG_FILL = 1u << 1;
+    const uint32_t FLAG_ROOMS = 1u << 2;
+    // Then symmetry, border and loop bits for the horizontal axis, then the vertical one
+    const uint32_t FLAG_AXES = 3;
+
+    // Manifest file, little endian:
+    //   ManifestHeader
+    //   ManifestRecord[mapCount]
+    //   names        every map name back to back, not NUL-terminated
+    // The checksum covers the records and the names.
+#pragma pack(push, 1)
+    struct ManifestHeader {
+        char magic[4];
+        uint16_t version;
+        uint16_t headerSize;
+        uint32_t mapCount;
+        uint32_t recordSize;
+        uint64_t namesSize;
+        uint32_t checksum;
+        uint32_t reserved;
+    };
+
+    struct ManifestRecord {
+        uint64_t nameOffset;
+        uint32_t nameLength;
+        uint32_t flags;
+        uint32_t width;
+        uint32_t height;
+        uint64_t fileSize;
+        int64_t fileTime;
+        uint32_t checksum;
+        uint32_t seed;
+        char preset[16];  // NUL-padded
+        float straightness;
+        float imperfect;
+        float fill;
+        float rooms;
+        uint8_t symmetry[2];  // Horizontal, vertical
+        uint8_t loop[2];
+        int32_t border[2];
+        uint32_t thumbnail[MapInfo::THUMBNAIL_SIZE];
+    };
+#pragma pack(pop)
+
+    int64_t writeTime(const fs::path& path, std::error_code& error) {
+        return fs::last_write_time(path, error).time_since_epoch().count();
+    }
+
+    void writeAxis(const MapInfo::Axis& axis, int index, ManifestRecord& record) {
+        const int shift = FLAG_AXES + index * 3;
+        record.flags |= (axis.symmetry ? 1u : 0u) << shift | (axis.border ? 2u : 0u) << shift |
+                        (axis.loop ? 4u : 0u) << shift;
+        record.symmetry[index] = axis.symmetry.value_or(false);
+        record.border[index] = axis.border.value_or(0);
+        record.loop[index] = axis.loop.value_or(false);
+    }
+
+    MapInfo::Axis readAxis(const ManifestRecord& record, int index) {
+        const uint32_t flags = record.flags >> (FLAG_AXES + index * 3);
+        MapInfo::Axis axis;
+        if (flags & 1) axis.symmetry = record.symmetry[index] != 0;
+        if (flags & 2) axis.border = record.border[index];
+        if (flags & 4) axis.loop = record.loop[index] != 0;
+        return axis;
+    }
+}
+
+bool MapManifest::load(const std::string& directory, bool allowStale) {
+    maps.clear();
+    const fs::path path = fs::path(directory) / FILENAME;
+
+    // Anything added, removed or renamed after the manifest was written moves the directory's time past it
+    std::error_code error;
+    if (!allowStale) {
+        const int64_t directoryTime = writeTime(directory, error);
+        const int64_t manifestTime = error ? 0 : writeTime(path, error);
+        if (error || directoryTime > manifestTime) {
+            return false;
+        }
+    }
+
+    MappedFile file;
+    if (!file.open(path.string())) {
+        return false;
+    }
+
+    const uint8_t* data = file.data();
+    const size_t size = file.size();
+    const ManifestHeader* header = reinterpret_cast<const ManifestHeader*>(data);
+    if (size < sizeof(ManifestHeader) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        header->version != VERSION || header->headerSize != sizeof(ManifestHeader) ||
+        header->recordSize != sizeof(ManifestRecord) ||
+        sizeof(ManifestHeader) + uint64_t(header->mapCount) * sizeof(ManifestRecord) + header->namesSize != size) {
+        std::cout << "Warning: Ignoring unreadable map manifest: " << path.string() << std::endl;
+        return false;
+    }
+
+    const uint8_t* body = data + sizeof(ManifestHeader);
+    if (MapFormat::checksum(body, size - sizeof(ManifestHeader)) != header->checksum) {
+        std::cout << "Warning: Ignoring map manifest with a bad checksum: " << path.string() << std::endl;
+        return false;
+    }
+
+    const ManifestRecord* records = reinterpret_cast<const ManifestRecord*>(body);
+    const char* names = reinterpret_cast<const char*>(body + header->mapCount * sizeof(ManifestRecord));
+    maps.resize(header->mapCount);
+    for (uint32_t i = 0; i < header->mapCount; ++i) {
+        const ManifestRecord& record = records[i];
+        if (record.nameOffset + record.nameLength > header->namesSize) {
+            std::cout << "Warning: Ignoring corrupt map manifest: " << path.string() << std::endl;
+            maps.clear();
+            return false;
+        }
+
+        MapInfo& info = maps[i];
+        info.name.assign(names + record.nameOffset, record.nameLength);
+        info.width = static_cast<int>(record.width);
+        info.height = static_cast<int>(record.height);
+        info.fileSize = record.fileSize;
+        info.fileTime = record.fileTime;
+        info.checksum = record.checksum;
+        info.generated = (record.flags & FLAG_GENERATED) != 0;
+        info.preset.assign(record.preset, strnlen(record.preset, sizeof(record.preset)));
+        info.seed = record.seed;
+        info.straightness = record.straightness;
+        info.imperfect = record.imperfect;
+        if (record.flags & FLAG_FILL) info.fill = record.fill;
+        if (record.flags & FLAG_ROOMS) info.rooms = record.rooms;
+        info.horizontal = readAxis(record, 0);
+        info.vertical = readAxis(record, 1);
+        std::copy(record.thumbnail, record.thumbnail + MapInfo::THUMBNAIL_SIZE, info.thumbnail.begin());
+    }
+    return true;
+}
+
+bool MapManifest::save(const std::string& directory) const {
+    std::vector<ManifestRecord> records(maps.size());
+    std::string names;
+    for (size_t i = 0; i < maps.size(); ++i) {
+        const MapInfo& info = maps[i];
+        ManifestRecord& record = records[i];
+        std::memset(&record, 0, sizeof(record));
+        record.nameOffset = names.size();
+        record.nameLength = static_cast<uint32_t>(info.name.size());
+        record.flags = (info.generated ? FLAG_GENERATED : 0) | (info.fill ? FLAG_FILL : 0) |
+                       (info.rooms ? FLAG_ROOMS : 0);
+        record.width = info.width;
+        record.height = info.height;
+        record.fileSize = info.fileSize;
+        record.fileTime = info.fileTime;
+        record.checksum = info.checksum;
+        record.seed = info.seed;
+        std::strncpy(record.preset, info.preset.c_str(), sizeof(record.preset));
+        record.straightness = info.straightness;
+        record.imperfect = info.imperfect;
+        record.fill = info.fill.value_or(0.0f);
+        record.rooms = info.rooms.value_or(0.0f);
+        writeAxis(info.horizontal, 0, record);
+        writeAxis(info.vertical, 1, record);
+        std::copy(info.thumbnail.begin(), info.thumbnail.end(), record.thumbnail);
+        names += info.name;
+    }
+
+    const size_t recordBytes = records.size() * sizeof(ManifestRecord);
+    ManifestHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.headerSize = sizeof(ManifestHeader);
+    header.mapCount = static_cast<uint32_t>(records.size());
+    header.recordSize = sizeof(ManifestRecord);
+    header.namesSize = names.size();
+    header.checksum = MapFormat::checksum(reinterpret_cast<const uint8_t*>(records.data()), recordBytes);
+    header.checksum = MapFormat::checksum(reinterpret_cast<const uint8_t*>(names.data()), names.size(), header.checksum);
+
+    // Written in place: the directory time only moves if the file is new, and then before the file's own time
+    const std::string path = (fs::path(directory) / FILENAME).string();
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), recordBytes);
+    file.write(names.data(), names.size());
+    if (!file) {
+        std::cout << "Error: Could not write map manifest: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool MapManifest::refresh(const std::string& directory, const std::vector<MapInfo>& fresh) {
+    MapManifest previous;
+    previous.load(directory, true);
+
+    std::unordered_map<std::string, const MapInfo*> given;
+    for (const MapInfo& info : fresh) {
+        given[info.name] = &info;
+    }
+
+    std::vector<MapInfo> indexed;
+    for (const std::string& name : scanDirectory(directory)) {
+        const fs::path path = fs::path(directory) / name;
+        std::error_code error;
+        const uint64_t fileSize = fs::file_size(path, error);
+        const int64_t fileTime = error ? 0 : writeTime(path, error);
+        if (error) {
+            continue;
+        }
+
+        const MapInfo* old = previous.find(name);
+        auto found = given.find(name);
+        MapInfo info;
+        if (found != given.end()) {
+            info = *found->second;
+        } else if (old && old->fileSize == fileSize && old->fileTime == fileTime) {
+            info = *old;
+        } else {
+            MapData map;
+            bool loaded = MapFormat::hasExtension(name, MapFormat::BINARY_EXTENSION)
+                              ? MapFormat::readBinary(path.string(), map)
+                              : MapFormat::readCSV(path.string(), map);
+            if (!loaded) {
+                std::cout << "Warning: Could not index map: " << path.string() << std::endl;
+                continue;
+            }
+            info = describe(name, map);
+
+            // Same tiles as before (the file was only rewritten): keep the generator settings
+            if (old && old->checksum == info.checksum) {
+                info.generated = old->generated;
+                info.preset = old->preset;
+                info.seed = old->seed;
+                info.straightness = old->straightness;
+                info.imperfect = old->imperfect;
+                info.fill = old->fill;
+                info.rooms = old->rooms;
+                info.horizontal = old->horizontal;
+                info.vertical = old->vertical;
+            }
+        }
+
+        info.fileSize = fileSize;
+        info.fileTime = fileTime;
+        indexed.push_back(std::move(info));
+    }
+
+    maps = std::move(indexed);
+    return save(directory);
+}
+
+const MapInfo* MapManifest::find(const std::string& name) const {
+    auto found = std::lower_bound(maps.begin(), maps.end(), name,
+                                  [](const MapInfo& info, const std::string& key) { return info.name < key; });
+    return found != maps.end() && found->name == name ? &*found : nullptr;
+}
+
+MapInfo MapManifest::describe(const std::string& name, const MapData& map) {
+    MapInfoBuilder builder(name, map.width, map.height, map.solidTypes);
+    for (int y = 0; y < map.height; ++y) {
+        builder.addRow(&map.types[static_cast<size_t>(y) * map.width]);
+    }
+    if (!map.variants.empty()) {
+        builder.addChecksum(map.variants.data(), map.variants.size());
+    }
+    return builder.finish();
+}
+
+std::vector<std::string> MapManifest::scanDirectory(const std::string& directory) {
+    std::vector<std::string> names;
+    try {
+        for (const auto& entry : fs::directory_iterator(directory)) {
+            const std::string name = entry.path().filename().string();
+            if (entry.is_regular_file() && (MapFormat::hasExtension(name, ".csv") ||
+                                            MapFormat::hasExtension(name, MapFormat::BINARY_EXTENSION))) {
+                names.push_back(name);
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cout << "Warning: Could not read maps directory: " << e.what() << std::endl;
+    }
+
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+MapInfoBuilder::MapInfoBuilder(const std::string& name, int width, int height)
+    : MapInfoBuilder(name, width, height, MapData().solidTypes) {}
+
+MapInfoBuilder::MapInfoBuilder(const std::string& name, int width, int height,
+                               const std::array<bool, 256>& solidTypes)
+    : solidTypes_(solidTypes), solidCounts_(SIZE * SIZE, 0) {
+    info_.name = name;
+    info_.width = width;
+    info_.height = height;
+    info_.checksum = MapFormat::checksum(nullptr, 0);
+    for (int tx = 0; tx <= SIZE; ++tx) {
+        columnEdges_[tx] = tx * width / SIZE;
+    }
+}
+
+void MapInfoBuilder::addRow(const uint8_t* types) {
+    const int width = info_.width;
+    const int height = info_.height;
+    info_.checksum = MapFormat::checksum(types, width, info_.checksum);
+
+    // Every thumbnail row whose band covers this row (several when the map is
+    // smaller than the thumbnail, since small maps repeat tiles)
+    const int y = row_++;
+    for (int ty = y * SIZE / height; ty < SIZE; ++ty) {
+        const int y0 = ty * height / SIZE;
+        const int y1 = std::max(y0 + 1, (ty + 1) * height / SIZE);
+        if (y0 > y) {
+            break;
+        }
+        if (y >= y1) {
+            continue;
+        }
+
+        uint32_t* counts = &solidCounts_[static_cast<size_t>(ty) * SIZE];
+        for (int tx = 0; tx < SIZE; ++tx) {
+            const int x0 = columnEdges_[tx];
+            const int x1 = std::max(x0 + 1, columnEdges_[tx + 1]);
+            for (int x = x0; x < x1; ++x) {
+                counts[tx] += solidTypes_[types[x]];
+            }
+        }
+    }
+}
+
+void MapInfoBuilder::addChecksum(const uint8_t* data, size_t size) {
+    info_.checksum = MapFormat::checksum(data, size, info_.checksum);
+}
+
+const MapInfo& MapInfoBuilder::finish() {
+    // Majority vote of the tiles under each thumbnail pixel
+    const int width = info_.width;
+    const int height = info_.height;
+    info_.thumbnail.fill(0);
+    for (int ty = 0; ty < SIZE && width > 0 && height > 0; ++ty) {
+        const int y0 = ty * height / SIZE;
+        const int rows = std::max(y0 + 1, (ty + 1) * height / SIZE) - y0;
+        for (int tx = 0; tx < SIZE; ++tx) {
+            const int columns = std::max(columnEdges_[tx] + 1, columnEdges_[tx + 1]) - columnEdges_[tx];
+            if (solidCounts_[static_cast<size_t>(ty) * SIZE + tx] * 2 > static_cast<uint32_t>(rows * columns)) {
+                info_.thumbnail[ty] |= 1u << tx;
+            }
+        }
+    }
+    return info_;
+}
\ No newline at end of file
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "map_format.h"
+
+// What a manifest knows about one map file
+struct MapInfo {
+    static constexpr int THUMBNAIL_SIZE = 32;
+
+    std::string name;       // File name in the maps directory
+    int width = 0;
+    int height = 0;
+    uint64_t fileSize = 0;
+    int64_t fileTime = 0;   // Last write time when indexed (filesystem clock ticks)
+    uint32_t checksum = 0;  // FNV-1a of the tile planes, the same for CSV and binary
+
+    // Generator settings for one maze axis; unset where the generator ignores them
+    struct Axis {
+        std::optional<bool> symmetry;
+        std::optional<int> border;
+        std::optional<bool> loop;
+    };
+
+    // Generator settings, when generate_maps wrote the map
+    bool generated = false;
+    std::string preset;     // Preset name, or "custom"
+    uint32_t seed = 0;      // Seed that regenerates the map (0 = not recorded)
+    float straightness = 0.0f;
+    float imperfect = 0.0f;
+    std::optional<float> fill;
+    std::optional<float> rooms;
+    Axis horizontal;
+    Axis vertical;
+
+    // Solid mask, THUMBNAIL_SIZE squared: bit x of row y is set when most of the
+    // tiles under that thumbnail pixel are solid
+    std::array<uint32_t, THUMBNAIL_SIZE> thumbnail{};
+
+    bool thumbnailSolid(int x, int y) const { return (thumbnail[y] >> x) & 1; }
+};
+
+// Builds a MapInfo from rows fed in order, for maps streamed to disk that are
+// never held whole (MapManifest::describe gives the same result for a MapData)
+class MapInfoBuilder {
+public:
+    MapInfoBuilder(const std::string& name, int width, int height);
+    MapInfoBuilder(const std::string& name, int width, int height, const std::array<bool, 256>& solidTypes);
+
+    void addRow(const uint8_t* types);
+
+    // Continue the checksum over more data (the variant plane, after every row)
+    void addChecksum(const uint8_t* data, size_t size);
+
+    const MapInfo& finish();
+
+private:
+    static constexpr int SIZE = MapInfo::THUMBNAIL_SIZE;
+
+    MapInfo info_;
+    std::array<bool, 256> solidTypes_;
+    std::array<int, SIZE + 1> columnEdges_;        // Tile column where each thumbnail column starts
+    std::vector<uint32_t> solidCounts_;            // Per thumbnail pixel
+    int row_ = 0;
+};
+
+// Index of a maps directory, kept in FILENAME inside it by generate_maps, so the
+// game can list, sort and filter maps with one file read instead of scanning the
+// directory and parsing maps.
+// A manifest is stale once the directory changed after it was written (maps
+// added, removed or renamed); load() then fails and callers fall back to a scan.
+class MapManifest {
+public:
+    static constexpr const char* FILENAME = "manifest.crindex";
+    static constexpr uint16_t VERSION = 2;
+
+    std::vector<MapInfo> maps;  // Sorted by name
+
+    // Read directory's manifest; false if it is missing, corrupt or stale
+    // (allowStale skips the staleness check)
+    bool load(const std::string& directory, bool allowStale = false);
+    bool save(const std::string& directory) const;
+
+    // Re-index directory: drop maps that are gone, take fresh entries (maps just
+    // written, with generator settings) as given, keep unchanged entries and parse
+    // anything else. Then save.
+    bool refresh(const std::string& directory, const std::vector<MapInfo>& fresh = {});
+
+    const MapInfo* find(const std::string& name) const;
+
+    // Dimensions, checksum and thumbnail of map (file fields are left empty)
+    static MapInfo describe(const std::string& name, const MapData& map);
+
+    // Map file names in directory (.csv and .crmap), sorted
+    static std::vector<std::string> scanDirectory(const std::string& directory);
+};
\ No newline at end of file
@@ -1,12 +1,86 @@
 #include "maze_generator.h"
+#include "thread_pool.h"
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <cstdio>
+#include <charconv>
 #include <algorithm>
-#include <stack>
+#include <type_traits>
 #include <cmath>
 
-std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeConfig& config) {
+namespace {
+    // Call f with std::true_type or std::false_type so a runtime flag becomes a template argument
+    template<class F>
+    void withFlag(bool flag, F&& f) {
+        if (flag) {
+            f(std::true_type{});
+        } else {
+            f(std::false_type{});
+        }
+    }
+    
+    // Fold a coordinate that stepped at most one grid width outside back in.
+    // Non-wrapping axes never leave the grid, so they compile to nothing.
+    template<bool Wrap>
+    inline int wrapCoord(int value, int size) {
+        if (Wrap) {
+            if (value < 0) return value + size;
+            if (value >= size) return value - size;
+        }
+        return value;
+    }
+    
+    template<bool HWrap, bool VWrap, bool HSymmetry, bool VSymmetry>
+    struct MazeLayout {
+        static constexpr bool hWrap = HWrap;
+        static constexpr bool vWrap = VWrap;
+        
+        int w, h;
+        
+        // Write a cell and its mirror images. A wrapping axis has no border column,
+        // so cell 0 on that axis has no mirror.
+        void set(MazeGrid& maze, int x, int y, uint8_t value) const {
+            x = wrapCoord<HWrap>(x, w);
+            y = wrapCoord<VWrap>(y, h);
+            
+            maze.at(x, y) = value;
+            
+            const int u = w - x - (HWrap ? 0 : 1);
+            const int v = h - y - (VWrap ? 0 : 1);
+            const bool mirrorX = HSymmetry && (!HWrap || x != 0);
+            const bool mirrorY = VSymmetry && (!VWrap || y != 0);
+            
+            if (mirrorX) {
+                maze.at(u, y) = value;
+                if (mirrorY) {
+                    maze.at(u, v) = value;
+                }
+            }
+            
+            if (mirrorY) {
+                maze.at(x, v) = value;
+            }
+        }
+    };
+    
+    // Seed 0 asks for a random maze
+    template<class Rng>
+    void seedRandom(Rng& rng, unsigned int seed) {
+        if (seed == 0) {
+            std::random_device rd;
+            rng.seed((static_cast<uint64_t>(rd()) << 32) | rd());
+        } else {
+            rng.seed(seed);
+        }
+    }
+    
+    // Lattice directions in MazeGenerator's order: west, east, south, north.
+    // d ^ 1 is the opposite direction.
+    const int LATTICE_DX[4] = {-1, 1, 0, 0};
+    const int LATTICE_DY[4] = {0, 0, 1, -1};
+}
+
+template<class Rng>
+MazeGrid MazeGenerator::generate(int w, int h, const MazeConfig& config) {
     const bool hSymmetry = config.horizontal.symmetry;
     const int hBorder = config.horizontal.border;
     const bool hWrap = config.horizontal.loop && !(hSymmetry && hBorder);
@@ -16,14 +90,8 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
     const bool vWrap = config.vertical.loop && !(vSymmetry && vBorder);
     
     // Setup random number generator
-    std::mt19937 rng;
-    if (config.seed == 0) {
-        std::random_device rd;
-        rng.seed(rd());
-    } else {
-        rng.seed(config.seed);
-    }
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+    Rng rng;
+    seedRandom(rng, config.seed);
     
     // Account for edges that will later be stripped
     if (!hBorder) {
@@ -36,7 +104,6 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
         if (!vWrap) ++h;
     }
     
-    float imperfect = std::min(1.0f, std::max(0.0f, config.imperfect));
     float fill = config.fill;
     float reserveProb = std::pow(1.0f - std::min(std::max(0.0f, fill * 0.9f + 0.1f), 1.0f), 1.6f);
     
@@ -62,29 +129,58 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
     }
     
     // Initialize maze to solid
-    std::vector<std::vector<int>> maze(w, std::vector<int>(h, SOLID));
+    MazeGrid maze(w, h, SOLID);
     
-    // Reserve some regions
+    // Reserve some regions (visited column by column to keep the random sequence stable)
     if (reserveProb > 0) {
+        const uint32_t reserveChance = chanceThreshold(reserveProb);
         for (int x = 1; x < w; x += 2) {
             for (int y = 1; y < h; y += 2) {
-                if (dist(rng) < reserveProb) {
-                    maze[x][y] = RESERVED;
+                if (randomChance(rng, reserveChance)) {
+                    maze.at(x, y) = RESERVED;
                 }
             }
         }
     }
     
+    // Carve hallways and add imperfections with the axis flags fixed at compile time
+    std::vector<DeadEnd> deadEnds;
+    withFlag(hWrap, [&](auto hWrapFlag) {
+        withFlag(vWrap, [&](auto vWrapFlag) {
+            withFlag(hSymmetry, [&](auto hSymmetryFlag) {
+                withFlag(vSymmetry, [&](auto vSymmetryFlag) {
+                    using Layout = MazeLayout<decltype(hWrapFlag)::value, decltype(vWrapFlag)::value,
+                                              decltype(hSymmetryFlag)::value, decltype(vSymmetryFlag)::value>;
+                    carve(maze, Layout{w, h}, rng, config, deadEnds);
+                });
+            });
+        });
+    });
+    
+    // Add rooms if requested
+    if (config.roomsFraction > 0) {
+        addRooms(maze, deadEnds, config);
+    }
+    
+    return maze;
+}
+
+template<class Layout, class Rng>
+void MazeGenerator::carve(MazeGrid& maze, const Layout& layout, Rng& rng, const MazeConfig& config,
+                          std::vector<DeadEnd>& deadEnds) {
+    const int w = layout.w;
+    const int h = layout.h;
+    
     // Carve hallways using stack-based approach
     std::vector<StackEntry> stack;
-    std::vector<DeadEnd> deadEnds;
     
     int startX = std::floor(w / 4.0f) * 2 - 1;
     int startY = std::floor(h / 4.0f) * 2 - 1;
     stack.push_back({startX, startY, {0, 0}});
     deadEnds.push_back({startX, startY});
     
-    std::vector<Direction> directions = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+    Direction directions[4] = {{-1, 0}, {1, 0}, {0, 1}, {0, -1}};
+    const uint32_t straightChance = chanceThreshold(config.straightness);
     int ignoreReserved = std::max(w, h);
     
     while (!stack.empty()) {
@@ -93,10 +189,10 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
         
         if (unexplored(maze, cur.x, cur.y, ignoreReserved)) {
             // Mark visited
-            setMaze(maze, cur.x, cur.y, EMPTY, config, w, h);
+            layout.set(maze, cur.x, cur.y, EMPTY);
             
             // Carve wall back towards source
-            setMaze(maze, cur.x - cur.step.x, cur.y - cur.step.y, EMPTY, config, w, h);
+            layout.set(maze, cur.x - cur.step.x, cur.y - cur.step.y, EMPTY);
             
             --ignoreReserved;
             
@@ -104,7 +200,7 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
             shuffle(directions, rng);
             
             // Prioritize straight lines
-            if (dist(rng) < config.straightness) {
+            if (randomChance(rng, straightChance)) {
                 for (int i = 0; i < 4; ++i) {
                     if (directions[i].x == cur.step.x && directions[i].y == cur.step.y) {
                         std::swap(directions[i], directions[3]);
@@ -116,13 +212,11 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
             // Check neighbors
             bool deadEnd = true;
             for (const auto& step : directions) {
-                int x = cur.x + step.x * 2;
-                int y = cur.y + step.y * 2;
+                int x = wrapCoord<Layout::hWrap>(cur.x + step.x * 2, w);
+                int y = wrapCoord<Layout::vWrap>(cur.y + step.y * 2, h);
                 
-                if (hWrap) x = (x + w) % w;
-                if (vWrap) y = (y + h) % h;
-                
-                if (x >= 0 && y >= 0 && x < w && y < h && unexplored(maze, x, y, ignoreReserved)) {
+                bool inside = (Layout::hWrap || (x >= 0 && x < w)) && (Layout::vWrap || (y >= 0 && y < h));
+                if (inside && unexplored(maze, x, y, ignoreReserved)) {
                     stack.push_back({x, y, step});
                     deadEnd = false;
                 }
@@ -135,66 +229,489 @@ std::vector<std::vector<int>> MazeGenerator::generate(int w, int h, const MazeCo
     }
     
     // Add imperfections (loops)
+    const float imperfect = std::min(1.0f, std::max(0.0f, config.imperfect));
     if (imperfect > 0) {
-        int hBdry = hWrap ? 0 : 1;
-        int vBdry = vWrap ? 0 : 1;
+        const int hBdry = Layout::hWrap ? 0 : 1;
+        const int vBdry = Layout::vWrap ? 0 : 1;
         
+        // Candidates on a bordered axis are at least one cell away from the edge,
+        // so only wrapping axes need their neighbors folded
         auto remove = [&](int x, int y) {
-            int a = maze[x][(y + 1) % h];
-            int b = maze[x][(y - 1 + h) % h];
-            int c = maze[(x + 1) % w][y];
-            int d = maze[(x - 1 + w) % w][y];
+            uint8_t a = maze.at(x, wrapCoord<Layout::vWrap>(y + 1, h));
+            uint8_t b = maze.at(x, wrapCoord<Layout::vWrap>(y - 1, h));
+            uint8_t c = maze.at(wrapCoord<Layout::hWrap>(x + 1, w), y);
+            uint8_t d = maze.at(wrapCoord<Layout::hWrap>(x - 1, w), y);
             if (std::min({a, b, c, d}) == EMPTY) {
-                setMaze(maze, x, y, EMPTY, config, w, h);
+                layout.set(maze, x, y, EMPTY);
             }
         };
         
-        std::uniform_int_distribution<int> xDist(0, w * 0.5 - hBdry * 2 - 1);
-        std::uniform_int_distribution<int> yDist(0, h * 0.5 - vBdry * 2 - 1);
+        const int xCount = static_cast<int>(w * 0.5 - hBdry * 2 - 1) + 1;
+        const int yCount = static_cast<int>(h * 0.5 - vBdry * 2 - 1) + 1;
         
-        for (int i = std::ceil(imperfect * w * h / 3.0f); i > 0; --i) {
-            remove(xDist(rng) * 2 + 1, yDist(rng) * 2 + vBdry * 2);
-            remove(xDist(rng) * 2 + hBdry * 2, yDist(rng) * 2 + 1);
+        for (int i = std::ceil(imperfect * w * h / 3.0f); i > 0 && xCount > 0 && yCount > 0; --i) {
+            int x1 = randomBelow(rng, xCount);
+            int y1 = randomBelow(rng, yCount);
+            remove(x1 * 2 + 1, y1 * 2 + vBdry * 2);
+            int x2 = randomBelow(rng, xCount);
+            int y2 = randomBelow(rng, yCount);
+            remove(x2 * 2 + hBdry * 2, y2 * 2 + 1);
+        }
+    }
+}
+
+template<class Rng>
+MazeLattice MazeGenerator::generateLattice(int width, int height, const MazeConfig& config) {
+    Rng rng;
+    seedRandom(rng, config.seed);
+    
+    const bool wrapX = config.horizontal.loop;
+    const bool wrapY = config.vertical.loop;
+    MazeLattice lattice(MazeLattice::cellsFor(width, wrapX), MazeLattice::cellsFor(height, wrapY), wrapX, wrapY);
+    
+    carveLattice(lattice, 0, 0, lattice.getCellsX(), lattice.getCellsY(), rng, chanceThreshold(config.straightness));
+    lattice.clearScratch();
+    addLatticeLoops(lattice, 0, 0, lattice.getCellsX(), lattice.getCellsY(), rng, config.imperfect);
+    return lattice;
+}
+
+template<class Rng>
+MazeLattice MazeGenerator::generateLatticeParallel(int width, int height, const MazeConfig& config, ThreadPool& pool) {
+    Rng rng;
+    seedRandom(rng, config.seed);
+    
+    const bool wrapX = config.horizontal.loop;
+    const bool wrapY = config.vertical.loop;
+    MazeLattice lattice(MazeLattice::cellsFor(width, wrapX), MazeLattice::cellsFor(height, wrapY), wrapX, wrapY);
+    const int cellsX = lattice.getCellsX();
+    const int cellsY = lattice.getCellsY();
+    const int regionsX = (cellsX + LATTICE_REGION - 1) / LATTICE_REGION;
+    const int regionsY = (cellsY + LATTICE_REGION - 1) / LATTICE_REGION;
+    const int regions = regionsX * regionsY;
+    
+    std::vector<uint64_t> seeds(regions);
+    for (uint64_t& seed : seeds) {
+        seed = (static_cast<uint64_t>(rng.next()) << 32) | rng.next();
+    }
+    
+    // Regions touch disjoint bytes (see LATTICE_REGION), so they carve without locks.
+    // Each one's loops stay inside it too, though they may open its boundary edges.
+    const uint32_t straightChance = chanceThreshold(config.straightness);
+    for (int region = 0; region < regions; ++region) {
+        pool.submit([&, region] {
+            const int x0 = region % regionsX * LATTICE_REGION;
+            const int y0 = region / regionsX * LATTICE_REGION;
+            const int x1 = std::min(cellsX, x0 + LATTICE_REGION);
+            const int y1 = std::min(cellsY, y0 + LATTICE_REGION);
+            Rng regionRng(seeds[region]);
+            carveLattice(lattice, x0, y0, x1, y1, regionRng, straightChance);
+            addLatticeLoops(lattice, x0, y0, x1, y1, regionRng, config.imperfect);
+        });
+    }
+    pool.wait();
+    lattice.clearScratch();
+    
+    // Every pair of neighbouring regions, east (wrapping when the axis has more
+    // than one region) then south, in shuffled order
+    struct Join {
+        int region;
+        bool south;
+    };
+    std::vector<Join> joins;
+    joins.reserve(static_cast<size_t>(regions) * 2);
+    for (int region = 0; region < regions; ++region) {
+        const int rx = region % regionsX;
+        const int ry = region / regionsX;
+        if (rx + 1 < regionsX || (wrapX && regionsX > 1)) {
+            joins.push_back({region, false});
         }
+        if (ry + 1 < regionsY || (wrapY && regionsY > 1)) {
+            joins.push_back({region, true});
+        }
+    }
+    for (size_t i = joins.size(); i > 1; --i) {
+        std::swap(joins[i - 1], joins[randomBelow(rng, static_cast<uint32_t>(i))]);
     }
     
-    // Add rooms if requested
-    if (config.roomsFraction > 0) {
-        addRooms(maze, deadEnds, config);
+    // Kruskal over regions: each is already one tree, so a single opening per
+    // join that links two separate groups keeps the whole maze a tree
+    std::vector<int> parent(regions);
+    for (int region = 0; region < regions; ++region) {
+        parent[region] = region;
+    }
+    auto find = [&](int a) {
+        while (parent[a] != a) {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    };
+    
+    for (const Join& join : joins) {
+        const int rx = join.region % regionsX;
+        const int ry = join.region / regionsX;
+        const int neighbor = join.south ? (ry + 1) % regionsY * regionsX + rx
+                                        : ry * regionsX + (rx + 1) % regionsX;
+        const int a = find(join.region);
+        const int b = find(neighbor);
+        if (a == b) {
+            continue;
+        }
+        parent[a] = b;
+        
+        const int x0 = rx * LATTICE_REGION;
+        const int y0 = ry * LATTICE_REGION;
+        const int x1 = std::min(cellsX, x0 + LATTICE_REGION);
+        const int y1 = std::min(cellsY, y0 + LATTICE_REGION);
+        if (join.south) {
+            lattice.openSouth(x0 + randomBelow(rng, x1 - x0), y1 - 1);
+        } else {
+            lattice.openEast(x1 - 1, y0 + randomBelow(rng, y1 - y0));
+        }
+    }
+    return lattice;
+}
+
+template<class Rng>
+void MazeGenerator::carveLattice(MazeLattice& lattice, int x0, int y0, int x1, int y1, Rng& rng,
+                                 uint32_t straightChance) {
+    const int cellsX = lattice.getCellsX();
+    const int cellsY = lattice.getCellsY();
+    const bool wrapX = lattice.wrapsX() && x0 == 0 && x1 == cellsX;
+    const bool wrapY = lattice.wrapsY() && y0 == 0 && y1 == cellsY;
+    
+    // Neighbour of (x, y) in direction d, if it is inside the region
+    auto neighbor = [&](int x, int y, int d, int& nx, int& ny) {
+        nx = x + LATTICE_DX[d];
+        ny = y + LATTICE_DY[d];
+        if (wrapX) {
+            nx = nx < 0 ? cellsX - 1 : (nx == cellsX ? 0 : nx);
+        }
+        if (wrapY) {
+            ny = ny < 0 ? cellsY - 1 : (ny == cellsY ? 0 : ny);
+        }
+        return nx >= x0 && nx < x1 && ny >= y0 && ny < y1;
+    };
+    
+    const int startX = x0 + (x1 - x0) / 2;
+    const int startY = y0 + (y1 - y0) / 2;
+    
+    // Every cell the walk entered keeps the direction it was entered in. That is
+    // never 0 (west) without the cell's own east edge being open, so a cell is
+    // visited exactly when its nibble is non-zero, or it is the start.
+    auto visited = [&](int x, int y) {
+        return lattice.get(x, y) != 0 || (x == startX && y == startY);
+    };
+    
+    // Walk forward into unvisited cells; at a dead end step back against the
+    // direction the cell was entered in until a branch is left
+    int x = startX;
+    int y = startY;
+    int heading = -1;  // Direction of the last step forward
+    while (true) {
+        int candidates[4];
+        int count = 0;
+        bool straight = false;
+        for (int d = 0; d < 4; ++d) {
+            int nx, ny;
+            if (neighbor(x, y, d, nx, ny) && !visited(nx, ny)) {
+                candidates[count++] = d;
+                straight = straight || d == heading;
+            }
+        }
+        
+        if (count == 0) {
+            if (x == startX && y == startY) {
+                break;
+            }
+            const int entered = (lattice.get(x, y) >> MazeLattice::SCRATCH_SHIFT) & 3;
+            neighbor(x, y, entered ^ 1, x, y);
+            heading = (x == startX && y == startY) ? -1 : (lattice.get(x, y) >> MazeLattice::SCRATCH_SHIFT) & 3;
+            continue;
+        }
+        
+        // Prioritize straight lines
+        int d = heading;
+        if (!straight || !randomChance(rng, straightChance)) {
+            d = candidates[count == 1 ? 0 : randomBelow(rng, count)];
+        }
+        
+        int nx, ny;
+        neighbor(x, y, d, nx, ny);
+        switch (d) {
+            case 0: lattice.openEast(nx, ny); break;
+            case 1: lattice.openEast(x, y); break;
+            case 2: lattice.openSouth(x, y); break;
+            case 3: lattice.openSouth(nx, ny); break;
+        }
+        lattice.set(nx, ny, lattice.get(nx, ny) | (d << MazeLattice::SCRATCH_SHIFT));
+        x = nx;
+        y = ny;
+        heading = d;
+    }
+}
+
+template<class Rng>
+void MazeGenerator::addLatticeLoops(MazeLattice& lattice, int x0, int y0, int x1, int y1, Rng& rng,
+                                    float imperfect) {
+    imperfect = std::min(1.0f, std::max(0.0f, imperfect));
+    const int cellsX = x1 - x0;
+    const int cellsY = y1 - y0;
+    
+    // Edges that exist: the lattice's last column/row has no east/south edge unless the axis wraps
+    const int eastColumns = cellsX - (x1 == lattice.getCellsX() && !lattice.wrapsX() ? 1 : 0);
+    const int southRows = cellsY - (y1 == lattice.getCellsY() && !lattice.wrapsY() ? 1 : 0);
+    if (imperfect <= 0 || eastColumns <= 0 || southRows <= 0) {
+        return;
     }
     
-    return maze;
+    // One east and one south edge per round, rounds as in carve() (4 tiles per cell)
+    const uint64_t rounds = static_cast<uint64_t>(std::ceil(imperfect * 4.0 * cellsX * cellsY / 3.0));
+    for (uint64_t i = 0; i < rounds; ++i) {
+        lattice.openEast(x0 + randomBelow(rng, eastColumns), y0 + randomBelow(rng, cellsY));
+        lattice.openSouth(x0 + randomBelow(rng, cellsX), y0 + randomBelow(rng, southRows));
+    }
 }
 
-bool MazeGenerator::exportToCSV(const std::vector<std::vector<int>>& maze, const std::string& filename) {
+template<class Rng>
+bool MazeGenerator::generateRows(int width, int height, const MazeConfig& config,
+                                 const std::function<bool(const uint8_t*)>& sink, uint8_t floor, uint8_t wall) {
+    Rng rng;
+    seedRandom(rng, config.seed);
+    
+    const bool wrapX = config.horizontal.loop;
+    const int cellsX = MazeLattice::cellsFor(width, wrapX);
+    const int cellsY = MazeLattice::cellsFor(height, false);
+    const int tileWidth = MazeLattice::tilesFor(cellsX, wrapX);
+    
+    // Straighter mazes join more cells sideways and carry more cells down
+    const float straightness = std::min(1.0f, std::max(0.0f, config.straightness));
+    const uint32_t joinChance = chanceThreshold(0.5f + 0.45f * straightness);
+    const uint32_t downChance = chanceThreshold(0.3f + 0.5f * straightness);
+    const uint32_t loopChance = chanceThreshold(std::min(1.0f, std::max(0.0f, config.imperfect)) * 2.0f / 3.0f);
+    
+    // Per-row state, all O(width): each cell's set, a union-find over set labels
+    // (labels stay below cellsX), and the row's open edges
+    std::vector<int> label(cellsX);
+    std::vector<int> parent(cellsX);
+    std::vector<int> remaining(cellsX);     // Members of each set not yet given a way down
+    std::vector<uint8_t> hasDown(cellsX);
+    std::vector<int> relabel(cellsX);
+    std::vector<uint8_t> east(cellsX);
+    std::vector<uint8_t> south(cellsX);
+    std::vector<uint8_t> row(tileWidth);
+    
+    auto find = [&](int a) {
+        while (parent[a] != a) {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    };
+    
+    // First row: every cell its own set
+    for (int x = 0; x < cellsX; ++x) {
+        label[x] = x;
+    }
+    
+    std::fill(row.begin(), row.end(), wall);
+    if (!sink(row.data())) {
+        return false;
+    }
+    
+    for (int y = 0; y < cellsY; ++y) {
+        const bool lastRow = y == cellsY - 1;
+        for (int x = 0; x < cellsX; ++x) {
+            parent[x] = x;
+        }
+        
+        // Join neighbours sideways; the last row joins every set left so the maze connects.
+        // Cells already in one set only join to make a loop.
+        const int edges = wrapX && cellsX > 1 ? cellsX : cellsX - 1;
+        for (int x = 0; x < edges; ++x) {
+            const int next = x + 1 == cellsX ? 0 : x + 1;
+            const int a = find(label[x]);
+            const int b = find(label[next]);
+            bool open;
+            if (a != b) {
+                open = lastRow || randomChance(rng, joinChance);
+                if (open) {
+                    parent[a] = b;
+                }
+            } else {
+                open = loopChance > 0 && randomChance(rng, loopChance);
+            }
+            east[x] = open;
+        }
+        if (edges < cellsX) {
+            east[cellsX - 1] = 0;
+        }
+        
+        // Carry each set down at least once (its last member if chance picked none)
+        if (!lastRow) {
+            std::fill(remaining.begin(), remaining.end(), 0);
+            std::fill(hasDown.begin(), hasDown.end(), 0);
+            for (int x = 0; x < cellsX; ++x) {
+                label[x] = find(label[x]);
+                ++remaining[label[x]];
+            }
+            for (int x = 0; x < cellsX; ++x) {
+                const int set = label[x];
+                --remaining[set];
+                south[x] = randomChance(rng, downChance) || (remaining[set] == 0 && !hasDown[set]);
+                hasDown[set] |= south[x];
+            }
+        } else {
+            std::fill(south.begin(), south.end(), 0);
+        }
+        
+        // Hall row, then the wall row below it (the bottom border on the last row)
+        row[0] = wrapX && east[cellsX - 1] ? floor : wall;
+        for (int x = 0; x < cellsX; ++x) {
+            row[x * 2 + 1] = floor;
+            if (x * 2 + 2 < tileWidth) {
+                row[x * 2 + 2] = east[x] ? floor : wall;
+            }
+        }
+        if (!sink(row.data())) {
+            return false;
+        }
+        
+        std::fill(row.begin(), row.end(), wall);
+        for (int x = 0; x < cellsX; ++x) {
+            if (south[x]) {
+                row[x * 2 + 1] = floor;
+            }
+        }
+        if (!sink(row.data())) {
+            return false;
+        }
+        
+        // Next row: carried cells keep their set under a compact label, the rest start new sets
+        if (!lastRow) {
+            std::fill(relabel.begin(), relabel.end(), -1);
+            int labels = 0;
+            for (int x = 0; x < cellsX; ++x) {
+                if (south[x]) {
+                    int& compact = relabel[label[x]];
+                    if (compact < 0) {
+                        compact = labels++;
+                    }
+                    label[x] = compact;
+                }
+            }
+            for (int x = 0; x < cellsX; ++x) {
+                if (!south[x]) {
+                    label[x] = labels++;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int MazeGenerator::streamedWidth(int width, const MazeConfig& config) {
+    return MazeLattice::tilesFor(MazeLattice::cellsFor(width, config.horizontal.loop), config.horizontal.loop);
+}
+
+int MazeGenerator::streamedHeight(int height) {
+    return MazeLattice::tilesFor(MazeLattice::cellsFor(height, false), false);
+}
+
+bool MazeGenerator::exportToCSV(const MazeGrid& maze, const std::string& filename) {
     std::string fullPath = "assets/maps/" + filename;
-    std::ofstream file(fullPath);
     
-    if (!file.is_open()) {
+    if (writeCSV(maze, fullPath) == 0) {
         std::cout << "Error: Could not create CSV file: " << fullPath << std::endl;
         return false;
     }
     
-    int width = maze.size();
-    int height = maze.empty() ? 0 : maze[0].size();
+    std::cout << "Exported maze to: " << fullPath << " (" << maze.width << "x" << maze.height << ")" << std::endl;
+    return true;
+}
+
+size_t MazeGenerator::writeCSV(const MazeGrid& maze, const std::string& path) {
+    // One buffer per thread, reused across calls (batch generation writes thousands of maps)
+    thread_local std::string buffer;
+    formatCSV(maze, buffer);
+    
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return 0;
+    }
+    
+    size_t written = std::fwrite(buffer.data(), 1, buffer.size(), file);
+    bool ok = (std::fclose(file) == 0) && written == buffer.size();
+    return ok ? written : 0;
+}
+
+void MazeGenerator::formatCSV(const MazeGrid& maze, std::string& out) {
+    const int width = maze.width;
+    const int height = maze.height;
+    
+    // Tile ids for every cell value, formatted once
+    char tileText[256][4];
+    uint8_t tileLength[256];
+    for (int value = 0; value < 256; ++value) {
+        auto result = std::to_chars(tileText[value], tileText[value] + 4, convertTileValue(value));
+        tileLength[value] = static_cast<uint8_t>(result.ptr - tileText[value]);
+    }
+    
+    // Upper bound: dimensions line plus up to 3 digits and a separator per tile
+    out.resize(32 + static_cast<size_t>(height) * (static_cast<size_t>(width) * 4 + 1));
+    char* p = out.data();
+    char* end = p + out.size();
     
     // Write dimensions
-    file << width << "," << height << "\n";
+    p = std::to_chars(p, end, width).ptr;
+    *p++ = ',';
+    p = std::to_chars(p, end, height).ptr;
+    *p++ = '\n';
     
     // Write tile data (row by row)
     for (int y = 0; y < height; ++y) {
+        const uint8_t* row = maze.row(y);
         for (int x = 0; x < width; ++x) {
-            if (x > 0) file << ",";
-            file << convertTileValue(maze[x][y]);
+            if (x > 0) *p++ = ',';
+            const char* text = tileText[row[x]];
+            for (int i = 0; i < tileLength[row[x]]; ++i) {
+                *p++ = text[i];
+            }
         }
-        file << "\n";
+        *p++ = '\n';
     }
     
-    file.close();
-    std::cout << "Exported maze to: " << fullPath << " (" << width << "x" << height << ")" << std::endl;
+    out.resize(p - out.data());
+}
+
+bool MazeGenerator::exportToBinary(const MazeGrid& maze, const std::string& filename) {
+    std::string fullPath = "assets/maps/" + filename;
+    
+    if (!MapFormat::writeBinary(fullPath, toMapData(maze))) {
+        return false;
+    }
+    
+    std::cout << "Exported maze to: " << fullPath << " (" << maze.width << "x" << maze.height << ")" << std::endl;
     return true;
 }
 
+MapData MazeGenerator::toMapData(const MazeGrid& maze) {
+    MapData map;
+    map.width = maze.width;
+    map.height = maze.height;
+    map.types.resize(static_cast<size_t>(maze.width) * maze.height);
+    
+    for (int y = 0; y < maze.height; ++y) {
+        const uint8_t* src = maze.row(y);
+        uint8_t* dst = &map.types[static_cast<size_t>(y) * maze.width];
+        for (int x = 0; x < maze.width; ++x) {
+            dst[x] = static_cast<uint8_t>(convertTileValue(src[x]));
+        }
+    }
+    
+    return map;
+}
+
 int MazeGenerator::convertTileValue(int mazeValue) {
     switch (mazeValue) {
         case EMPTY: return 1;      // Floor
@@ -204,53 +721,23 @@ int MazeGenerator::convertTileValue(int mazeValue) {
     }
 }
 
-void MazeGenerator::shuffle(std::vector<Direction>& directions, std::mt19937& rng) {
-    for (int i = directions.size() - 1; i > 0; --i) {
-        std::uniform_int_distribution<int> dist(0, i);
-        int j = dist(rng);
+template<class Rng>
+void MazeGenerator::shuffle(Direction (&directions)[4], Rng& rng) {
+    for (int i = 3; i > 0; --i) {
+        int j = randomBelow(rng, i + 1);
         std::swap(directions[i], directions[j]);
     }
 }
 
-bool MazeGenerator::unexplored(const std::vector<std::vector<int>>& maze, int x, int y, int ignoreReserved) {
-    int c = maze[x][y];
+bool MazeGenerator::unexplored(const MazeGrid& maze, int x, int y, int ignoreReserved) {
+    uint8_t c = maze.at(x, y);
     return (c == SOLID) || ((c == RESERVED) && (ignoreReserved > 0));
 }
 
-void MazeGenerator::setMaze(std::vector<std::vector<int>>& maze, int x, int y, int value, 
-                           const MazeConfig& config, int w, int h) {
-    x = (x + w) % w;
-    y = (y + h) % h;
-    
-    maze[x][y] = value;
-    
-    const bool hSymmetry = config.horizontal.symmetry;
-    const bool vSymmetry = config.vertical.symmetry;
-    const bool hWrap = config.horizontal.loop && !(hSymmetry && config.horizontal.border);
-    const bool vWrap = config.vertical.loop && !(vSymmetry && config.vertical.border);
-    
-    const int hBorderOffset = hWrap ? 0 : 1;
-    const int vBorderOffset = vWrap ? 0 : 1;
-    
-    const int u = w - x - hBorderOffset;
-    const int v = h - y - vBorderOffset;
-    
-    if (hSymmetry && u < w) {
-        maze[u][y] = value;
-        if (vSymmetry && v < h) {
-            maze[u][v] = value;
-        }
-    }
-    
-    if (vSymmetry && v < h) {
-        maze[x][v] = value;
-    }
-}
-
-void MazeGenerator::addRooms(std::vector<std::vector<int>>& maze, const std::vector<DeadEnd>& deadEnds,
+void MazeGenerator::addRooms(MazeGrid& maze, const std::vector<DeadEnd>& deadEnds,
                             const MazeConfig& config) {
-    int w = maze.size();
-    int h = maze[0].size();
+    int w = maze.width;
+    int h = maze.height;
     
     float roomsFraction = std::max(0.0f, std::min(1.0f, config.roomsFraction));
     
@@ -264,11 +751,12 @@ void MazeGenerator::addRooms(std::vector<std::vector<int>>& maze, const std::vec
         int u = std::floor(c.x - a / 2.0f);
         int v = std::floor(c.y - b / 2.0f);
         
-        for (int x = std::max(config.wallWidth, u - a); 
-             x <= std::min(w - config.wallWidth - 1, u + a); ++x) {
-            for (int y = std::max(config.wallWidth, v - b); 
-                 y <= std::min(h - config.wallWidth, v + b); ++y) {
-                maze[x][y] = EMPTY;
+        for (int y = std::max(config.wallWidth, v - b); 
+             y <= std::min(h - config.wallWidth, v + b); ++y) {
+            uint8_t* row = maze.row(y);
+            for (int x = std::max(config.wallWidth, u - a); 
+                 x <= std::min(w - config.wallWidth - 1, u + a); ++x) {
+                row[x] = EMPTY;
             }
         }
     }
@@ -277,18 +765,37 @@ void MazeGenerator::addRooms(std::vector<std::vector<int>>& maze, const std::vec
     if (config.horizontal.symmetry) {
         int offset = config.horizontal.loop ? config.hallWidth + 1 : 1;
         for (int y = 0; y < h; ++y) {
+            uint8_t* row = maze.row(y);
             for (int x = 0; x <= w / 2; ++x) {
-                maze[w - offset - x][y] = maze[x][y];
+                row[w - offset - x] = row[x];
             }
         }
     }
     
     if (config.vertical.symmetry) {
         int offset = config.vertical.loop ? config.hallWidth + 1 : 1;
-        for (int x = 0; x < w; ++x) {
-            for (int y = 0; y <= h / 2; ++y) {
-                maze[x][h - offset - y] = maze[x][y];
+        // Columns are independent, so mirroring whole rows is equivalent
+        for (int y = 0; y <= h / 2; ++y) {
+            int mirror = h - offset - y;
+            if (mirror != y) {
+                std::copy(maze.row(y), maze.row(y) + w, maze.row(mirror));
             }
         }
     }
-}
\ No newline at end of file
+}
+
+template MazeGrid MazeGenerator::generate<Pcg32>(int, int, const MazeConfig&);
+template MazeGrid MazeGenerator::generate<Xoshiro128>(int, int, const MazeConfig&);
+template MazeGrid MazeGenerator::generate<MersenneTwister>(int, int, const MazeConfig&);
+template MazeLattice MazeGenerator::generateLattice<Pcg32>(int, int, const MazeConfig&);
+template MazeLattice MazeGenerator::generateLattice<Xoshiro128>(int, int, const MazeConfig&);
+template MazeLattice MazeGenerator::generateLattice<MersenneTwister>(int, int, const MazeConfig&);
+template MazeLattice MazeGenerator::generateLatticeParallel<Pcg32>(int, int, const MazeConfig&, ThreadPool&);
+template MazeLattice MazeGenerator::generateLatticeParallel<Xoshiro128>(int, int, const MazeConfig&, ThreadPool&);
+template MazeLattice MazeGenerator::generateLatticeParallel<MersenneTwister>(int, int, const MazeConfig&, ThreadPool&);
+template bool MazeGenerator::generateRows<Pcg32>(int, int, const MazeConfig&,
+                                                 const std::function<bool(const uint8_t*)>&, uint8_t, uint8_t);
+template bool MazeGenerator::generateRows<Xoshiro128>(int, int, const MazeConfig&,
+                                                      const std::function<bool(const uint8_t*)>&, uint8_t, uint8_t);
+template bool MazeGenerator::generateRows<MersenneTwister>(int, int, const MazeConfig&,
+                                                           const std::function<bool(const uint8_t*)>&, uint8_t, uint8_t);
\ No newline at end of file
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <functional>
 #include <vector>
 #include <string>
-#include <random>
+#include "maze_grid.h"
+#include "maze_lattice.h"
+#include "random.h"
+#include "map_format.h"
+
+class ThreadPool;
 
 struct MazeConfig {
     struct Axis {
@@ -28,19 +34,65 @@ struct DeadEnd {
 
 class MazeGenerator {
 public:
-    // Generate maze with given configuration
-    static std::vector<std::vector<int>> generate(int width, int height, const MazeConfig& config = MazeConfig{});
+    // Generate maze with given configuration.
+    // Rng is the random engine policy (see random.h); the same seed and engine give
+    // the same maze on every platform. Instantiated for Pcg32, Xoshiro128 and MersenneTwister.
+    template<class Rng = Pcg32>
+    static MazeGrid generate(int width, int height, const MazeConfig& config = MazeConfig{});
+    
+    // Lattice backend for mazes too big for a MazeGrid (see maze_lattice.h).
+    // A randomized depth-first backtracker that keeps its path in the lattice's
+    // scratch bits instead of a stack, so the 4 bits per cell are all the memory
+    // it needs. Honors straightness, imperfect, loop and seed; symmetry, fill and
+    // rooms are tile-grid passes and are ignored. width/height are in tiles.
+    template<class Rng = Pcg32>
+    static MazeLattice generateLattice(int width, int height, const MazeConfig& config = MazeConfig{});
+    
+    // generateLattice split into LATTICE_REGION square regions carved side by side
+    // on pool, then joined into one maze: a shuffled union-find pass over the
+    // regions opens one random boundary edge per join until all are connected.
+    // Region seeds are drawn from the seed up front and the join runs on one
+    // thread, so a seed gives the same maze whatever the pool size. The result
+    // differs from generateLattice's for the same seed.
+    template<class Rng = Pcg32>
+    static MazeLattice generateLatticeParallel(int width, int height, const MazeConfig& config, ThreadPool& pool);
+    
+    // Eller's algorithm: builds the maze one lattice row at a time (tile layout as
+    // in maze_lattice.h) and hands each tile row of floor/wall values to sink,
+    // never holding the whole maze, so memory is O(width) however tall the map.
+    // straightness lengthens horizontal and vertical runs, imperfect opens
+    // horizontal loops, and horizontal loop wraps. Vertical loop, symmetry, fill
+    // and rooms need the whole maze and are ignored. Rows come out at
+    // streamedWidth x streamedHeight. Returns false if sink does.
+    template<class Rng = Pcg32>
+    static bool generateRows(int width, int height, const MazeConfig& config,
+                             const std::function<bool(const uint8_t*)>& sink, uint8_t floor, uint8_t wall);
+    static int streamedWidth(int width, const MazeConfig& config);
+    static int streamedHeight(int height);
     
     // Export maze to CSV format
-    static bool exportToCSV(const std::vector<std::vector<int>>& maze, const std::string& filename);
+    static bool exportToCSV(const MazeGrid& maze, const std::string& filename);
+    
+    // Write maze CSV to an explicit path without logging; returns bytes written (0 on failure)
+    static size_t writeCSV(const MazeGrid& maze, const std::string& path);
+    
+    // Format maze CSV into out (replacing its contents); reuse out to avoid reallocating
+    static void formatCSV(const MazeGrid& maze, std::string& out);
+    
+    // Export maze to the binary map format (.crmap)
+    static bool exportToBinary(const MazeGrid& maze, const std::string& filename);
+    
+    // Convert maze cells to tile ids (see convertTileValue)
+    static MapData toMapData(const MazeGrid& maze);
     
     // Convert tile values: 0=floor(1), 255=wall(2), other=reserved
     static int convertTileValue(int mazeValue);
 
 private:
-    static constexpr int SOLID = 255;
-    static constexpr int RESERVED = 127; 
-    static constexpr int EMPTY = 0;
+    static constexpr uint8_t SOLID = 255;
+    static constexpr uint8_t RESERVED = 127; 
+    static constexpr uint8_t EMPTY = 0;
+    static constexpr int LATTICE_REGION = 256;  // Cells per side; even, so regions never share a byte
     
     struct Direction {
         int x, y;
@@ -52,10 +104,28 @@ private:
     };
     
     // Helper functions
-    static void shuffle(std::vector<Direction>& directions, std::mt19937& rng);
-    static bool unexplored(const std::vector<std::vector<int>>& maze, int x, int y, int ignoreReserved);
-    static void setMaze(std::vector<std::vector<int>>& maze, int x, int y, int value, 
-                       const MazeConfig& config, int w, int h);
-    static void addRooms(std::vector<std::vector<int>>& maze, const std::vector<DeadEnd>& deadEnds,
+    template<class Rng>
+    static void shuffle(Direction (&directions)[4], Rng& rng);
+    static bool unexplored(const MazeGrid& maze, int x, int y, int ignoreReserved);
+    
+    // Carving and imperfection passes, instantiated per symmetry/wrap combination
+    // (Layout) so the inner loops carry no config branches
+    template<class Layout, class Rng>
+    static void carve(MazeGrid& maze, const Layout& layout, Rng& rng, const MazeConfig& config,
+                      std::vector<DeadEnd>& deadEnds);
+    
+    static void addRooms(MazeGrid& maze, const std::vector<DeadEnd>& deadEnds,
                         const MazeConfig& config);
+    
+    // Spanning tree over cells [x0, x1) x [y0, y1) of lattice, grown from the
+    // region's middle. Reads and writes only cells inside the region, and wraps
+    // only along axes the region spans completely.
+    template<class Rng>
+    static void carveLattice(MazeLattice& lattice, int x0, int y0, int x1, int y1, Rng& rng,
+                             uint32_t straightChance);
+    
+    // Open random east and south edges of cells in [x0, x1) x [y0, y1): imperfect = 1
+    // opens about as many as the tile grid pass would
+    template<class Rng>
+    static void addLatticeLoops(MazeLattice& lattice, int x0, int y0, int x1, int y1, Rng& rng, float imperfect);
 };
\ No newline at end of file
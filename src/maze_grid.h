@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Contiguous row-major grid of 8-bit maze cells.
+// Cell (x, y) lives at cells[y * stride + x]; stride >= width so rows can be padded.
+struct MazeGrid {
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+    std::vector<uint8_t> cells;
+
+    MazeGrid() = default;
+    MazeGrid(int w, int h, uint8_t value = 0)
+        : width(w), height(h), stride(w), cells(static_cast<size_t>(w) * h, value) {}
+
+    bool empty() const { return cells.empty(); }
+
+    uint8_t& at(int x, int y) { return cells[static_cast<size_t>(y) * stride + x]; }
+    uint8_t at(int x, int y) const { return cells[static_cast<size_t>(y) * stride + x]; }
+
+    uint8_t* row(int y) { return cells.data() + static_cast<size_t>(y) * stride; }
+    const uint8_t* row(int y) const { return cells.data() + static_cast<size_t>(y) * stride; }
+};
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "maze_lattice.h"
+#include "map_format.h"
+
+MazeLattice::MazeLattice(int cellsX, int cellsY, bool wrapX, bool wrapY)
+    : cellsX_(cellsX), cellsY_(cellsY), stride_((cellsX + 1) & ~1), wrapX_(wrapX), wrapY_(wrapY),
+      nibbles_(static_cast<size_t>(stride_) / 2 * cellsY, 0) {}
+
+void MazeLattice::clearScratch() {
+    const uint8_t keep = EDGES | (EDGES << 4);
+    for (uint8_t& byte : nibbles_) {
+        byte &= keep;
+    }
+}
+
+void MazeLattice::expandRow(int tileY, uint8_t* out, uint8_t floor, uint8_t wall) const {
+    const int width = getTileWidth();
+    const bool hallRow = (tileY & 1) != 0;
+    const int cellY = hallRow ? tileY / 2 : tileY / 2 - 1;
+
+    // Border rows of a bordered axis
+    if (!hallRow && !wrapY_ && (tileY == 0 || tileY == cellsY_ * 2)) {
+        std::fill(out, out + width, wall);
+        return;
+    }
+
+    if (hallRow) {
+        // Halls, with the wall before each one open when its west edge is
+        out[0] = wrapX_ && eastOpen(cellsX_ - 1, cellY) ? floor : wall;
+        for (int x = 0; x < cellsX_; ++x) {
+            out[x * 2 + 1] = floor;
+            if (x + 1 < cellsX_) {
+                out[x * 2 + 2] = eastOpen(x, cellY) ? floor : wall;
+            }
+        }
+    } else {
+        // Wall row above cellY + 1: open under cells whose south edge is
+        const int above = cellY < 0 ? cellsY_ - 1 : cellY;
+        for (int x = 0; x < cellsX_; ++x) {
+            out[x * 2] = wall;
+            out[x * 2 + 1] = southOpen(x, above) ? floor : wall;
+        }
+    }
+
+    if (!wrapX_) {
+        out[width - 1] = wall;
+    }
+}
+
+bool MazeLattice::expandRows(const std::function<bool(const uint8_t*)>& sink, uint8_t floor, uint8_t wall) const {
+    std::vector<uint8_t> row(getTileWidth());
+    const int height = getTileHeight();
+    for (int y = 0; y < height; ++y) {
+        expandRow(y, row.data(), floor, wall);
+        if (!sink(row.data())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+MazeGrid MazeLattice::toGrid() const {
+    // MazeGenerator cell values: 0 hall, 255 wall
+    MazeGrid grid(getTileWidth(), getTileHeight());
+    for (int y = 0; y < grid.height; ++y) {
+        expandRow(y, grid.row(y), 0, 255);
+    }
+    return grid;
+}
+
+uint64_t MazeLattice::writeMap(const std::string& path) const {
+    MapRowWriter writer;
+    if (!writer.open(path, getTileWidth(), getTileHeight())) {
+        return 0;
+    }
+
+    const uint8_t floor = static_cast<uint8_t>(TileType::FLOOR);
+    const uint8_t wall = static_cast<uint8_t>(TileType::WALL_BRICK);
+    expandRows([&](const uint8_t* row) { return writer.writeRow(row); }, floor, wall);
+    return writer.close() ? writer.getBytesWritten() : 0;
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+#include "maze_grid.h"
+
+// Maze stored as its lattice of hall cells rather than as tiles. Cell (x, y) is
+// the hall tile (2x + 1, 2y + 1); the tiles between cells are walls unless the
+// edge between them is open, and the tiles between four cells are always wall.
+// Each cell keeps 4 bits: whether its east and south edges are open (west and
+// north are the neighbours' east and south) and 2 bits of scratch the carver
+// uses instead of a stack. A 64k x 64k tile maze fits in 512 MB where MazeGrid
+// needs 4 GB, and tiles only exist a row at a time when exporting.
+// A wrapping axis has one wall row/column per cell and no border: the wall
+// before cell 0 is the edge from the last cell back to it.
+class MazeLattice {
+public:
+    static constexpr uint8_t EAST = 1u << 0;
+    static constexpr uint8_t SOUTH = 1u << 1;
+    static constexpr uint8_t EDGES = EAST | SOUTH;
+    static constexpr int SCRATCH_SHIFT = 2;
+
+    MazeLattice() = default;
+    MazeLattice(int cellsX, int cellsY, bool wrapX, bool wrapY);
+
+    int getCellsX() const { return cellsX_; }
+    int getCellsY() const { return cellsY_; }
+    bool wrapsX() const { return wrapX_; }
+    bool wrapsY() const { return wrapY_; }
+    size_t getBytes() const { return nibbles_.size(); }
+
+    // Tile size of the expanded maze
+    int getTileWidth() const { return tilesFor(cellsX_, wrapX_); }
+    int getTileHeight() const { return tilesFor(cellsY_, wrapY_); }
+
+    // Tiles along an axis of cells, and cells for a requested tile count (rounded down)
+    static int tilesFor(int cells, bool wrap) { return cells * 2 + (wrap ? 0 : 1); }
+    static int cellsFor(int tiles, bool wrap) { return std::max(1, wrap ? tiles / 2 : (tiles - 1) / 2); }
+
+    uint8_t get(int x, int y) const {
+        const size_t i = index(x, y);
+        return (nibbles_[i >> 1] >> ((i & 1) * 4)) & 0xF;
+    }
+
+    void set(int x, int y, uint8_t value) {
+        const size_t i = index(x, y);
+        const int shift = (i & 1) * 4;
+        uint8_t& byte = nibbles_[i >> 1];
+        byte = static_cast<uint8_t>((byte & ~(0xF << shift)) | ((value & 0xF) << shift));
+    }
+
+    // Open the edge between (x, y) and its east or south neighbour
+    void openEast(int x, int y) { set(x, y, get(x, y) | EAST); }
+    void openSouth(int x, int y) { set(x, y, get(x, y) | SOUTH); }
+
+    bool eastOpen(int x, int y) const { return (get(x, y) & EAST) != 0; }
+    bool southOpen(int x, int y) const { return (get(x, y) & SOUTH) != 0; }
+
+    // Clear the carver's scratch bits, leaving only edges
+    void clearScratch();
+
+    // Tile row tileY of the expanded maze, getTileWidth() values of floor or wall
+    void expandRow(int tileY, uint8_t* out, uint8_t floor, uint8_t wall) const;
+
+    // Feed every expanded row to sink in order; stops early if sink returns false
+    bool expandRows(const std::function<bool(const uint8_t*)>& sink, uint8_t floor, uint8_t wall) const;
+
+    // The whole expanded maze with MazeGenerator cell values, for loading and small exports
+    MazeGrid toGrid() const;
+
+    // Stream the expanded maze to a map file (CSV, or binary for .crmap) without
+    // building it in memory; returns bytes written (0 on failure)
+    uint64_t writeMap(const std::string& path) const;
+
+private:
+    // Rows hold an even number of cells so no byte spans two rows, and regions
+    // starting on even columns never share a byte
+    size_t index(int x, int y) const { return static_cast<size_t>(y) * stride_ + x; }
+
+    int cellsX_ = 0;
+    int cellsY_ = 0;
+    int stride_ = 0;
+    bool wrapX_ = false;
+    bool wrapY_ = false;
+    std::vector<uint8_t> nibbles_;  // Two cells per byte, low nibble first
+};
\ No newline at end of file
@@ -0,0 +1,154 @@
+#include "maze_world.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+    // What a hash is for, so a chunk's maze and its two seams draw unrelated numbers
+    enum Salt : uint64_t { SALT_CHUNK = 1, SALT_WEST_SEAM = 2, SALT_NORTH_SEAM = 3 };
+
+    // splitmix64 finalizer
+    uint64_t mix(uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    uint64_t hashChunk(uint32_t seed, int chunkX, int chunkY, Salt salt) {
+        uint64_t h = mix(seed + salt * 0x9E3779B97F4A7C15ULL);
+        h = mix(h ^ static_cast<uint32_t>(chunkX));
+        return mix(h ^ (static_cast<uint64_t>(static_cast<uint32_t>(chunkY)) << 32));
+    }
+}
+
+MazeWorld::MazeWorld(uint32_t seed, const MazeConfig& config)
+    : seed_(seed), config_(config),
+      doorChance_(chanceThreshold(std::min(1.0f, std::max(0.0f, config.imperfect)) / 4.0f)) {
+    // Chunks are carved bordered and unmirrored; the seams replace the borders
+    config_.horizontal = MazeConfig::Axis{};
+    config_.vertical = MazeConfig::Axis{};
+    for (int i = 0; i < 256; ++i) {
+        solidTypes_[i] = isSolidTileType(static_cast<TileType>(i));
+    }
+}
+
+void MazeWorld::enter(Tilemap& map, int chunkX, int chunkY) {
+    originX_ = chunkX - WINDOW_CHUNKS / 2;
+    originY_ = chunkY - WINDOW_CHUNKS / 2;
+    buildWindow(map);
+    window_ = TileBuffer();
+    evictFar();
+}
+
+bool MazeWorld::follow(Tilemap& map, float centerX, float centerY, int& shiftX, int& shiftY) {
+    generateAhead();
+
+    const int dx = static_cast<int>(std::floor(centerX / CHUNK_PIXELS)) - WINDOW_CHUNKS / 2;
+    const int dy = static_cast<int>(std::floor(centerY / CHUNK_PIXELS)) - WINDOW_CHUNKS / 2;
+    if (dx == 0 && dy == 0) {
+        return false;
+    }
+
+    originX_ += dx;
+    originY_ += dy;
+    buildWindow(map);
+    evictFar();
+    ++stats_.shifts;
+    shiftX = dx * CHUNK_PIXELS;
+    shiftY = dy * CHUNK_PIXELS;
+    return true;
+}
+
+const std::vector<uint8_t>& MazeWorld::getChunk(int chunkX, int chunkY) {
+    Chunk& chunk = chunks_[key(chunkX, chunkY)];
+    if (chunk.types.empty()) {
+        chunk.x = chunkX;
+        chunk.y = chunkY;
+        generate(chunkX, chunkY, chunk.types);
+        ++stats_.generated;
+    }
+    return chunk.types;
+}
+
+void MazeWorld::generate(int chunkX, int chunkY, std::vector<uint8_t>& types) const {
+    const uint8_t floor = static_cast<uint8_t>(TileType::FLOOR);
+    const uint8_t wall = static_cast<uint8_t>(TileType::WALL_BRICK);
+
+    // The bordered lattice is one tile wider and taller than the chunk: its east
+    // column and south row are the neighbours' seams and are dropped
+    MazeConfig config = config_;
+    config.seed = static_cast<uint32_t>(hashChunk(seed_, chunkX, chunkY, SALT_CHUNK)) | 1;  // 0 would be random
+    MazeLattice lattice = MazeGenerator::generateLattice(CHUNK_SIZE + 1, CHUNK_SIZE + 1, config);
+
+    types.resize(static_cast<size_t>(CHUNK_SIZE) * CHUNK_SIZE);
+    std::vector<uint8_t> row(lattice.getTileWidth());
+    for (int y = 0; y < CHUNK_SIZE; ++y) {
+        lattice.expandRow(y, row.data(), floor, wall);
+        std::copy(row.begin(), row.begin() + CHUNK_SIZE, types.begin() + static_cast<size_t>(y) * CHUNK_SIZE);
+    }
+
+    // Doors through the west and north seams: one always, more with imperfect.
+    // Only this chunk's coordinate goes in, so the neighbour across never has to agree.
+    Pcg32 west(hashChunk(seed_, chunkX, chunkY, SALT_WEST_SEAM));
+    Pcg32 north(hashChunk(seed_, chunkX, chunkY, SALT_NORTH_SEAM));
+    const int westDoor = randomBelow(west, CHUNK_CELLS);
+    const int northDoor = randomBelow(north, CHUNK_CELLS);
+    for (int cell = 0; cell < CHUNK_CELLS; ++cell) {
+        if (cell == westDoor || randomChance(west, doorChance_)) {
+            types[static_cast<size_t>(cell * 2 + 1) * CHUNK_SIZE] = floor;
+        }
+        if (cell == northDoor || randomChance(north, doorChance_)) {
+            types[cell * 2 + 1] = floor;
+        }
+    }
+}
+
+void MazeWorld::buildWindow(Tilemap& map) {
+    window_.setSize(WINDOW_SIZE, WINDOW_SIZE);
+    for (int cy = 0; cy < WINDOW_CHUNKS; ++cy) {
+        for (int cx = 0; cx < WINDOW_CHUNKS; ++cx) {
+            const std::vector<uint8_t>& types = getChunk(originX_ + cx, originY_ + cy);
+            for (int y = 0; y < CHUNK_SIZE; ++y) {
+                const size_t offset = static_cast<size_t>(cy * CHUNK_SIZE + y) * WINDOW_SIZE + cx * CHUNK_SIZE;
+                std::copy(types.begin() + y * CHUNK_SIZE, types.begin() + (y + 1) * CHUNK_SIZE,
+                          window_.types.begin() + offset);
+            }
+        }
+    }
+    std::fill(window_.variants.begin(), window_.variants.end(), 0);
+    window_.buildSolid(solidTypes_);
+    map.swapBuffer(window_);
+}
+
+void MazeWorld::evictFar() {
+    const int centerX = getCenterX();
+    const int centerY = getCenterY();
+    for (auto it = chunks_.begin(); it != chunks_.end();) {
+        const Chunk& chunk = it->second;
+        if (std::max(std::abs(chunk.x - centerX), std::abs(chunk.y - centerY)) > KEEP_RADIUS) {
+            it = chunks_.erase(it);
+            ++stats_.evicted;
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MazeWorld::generateAhead() {
+    // Nearest missing chunk first, ring by ring; the window itself is always resident
+    const int centerX = getCenterX();
+    const int centerY = getCenterY();
+    for (int radius = WINDOW_CHUNKS / 2 + 1; radius <= KEEP_RADIUS; ++radius) {
+        for (int y = -radius; y <= radius; ++y) {
+            for (int x = -radius; x <= radius; ++x) {
+                if (std::max(std::abs(x), std::abs(y)) != radius) {
+                    continue;
+                }
+                if (chunks_.find(key(centerX + x, centerY + y)) == chunks_.end()) {
+                    getChunk(centerX + x, centerY + y);
+                    return;
+                }
+            }
+        }
+    }
+}
\ No newline at end of file
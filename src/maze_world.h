@@ -0,0 +1,89 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "maze_generator.h"
+#include "tilemap.h"
+
+// Endless maze made of square chunks, each generated on demand from the world
+// seed and its chunk coordinate, so any chunk comes out the same whenever it is
+// (re)generated and nothing but the seed has to be kept.
+// A chunk is CHUNK_CELLS x CHUNK_CELLS lattice cells (see maze_lattice.h) carved
+// as one tree, laid out like a wrapping lattice: its first tile column and row
+// are the walls it shares with its west and north neighbours. Those seams belong
+// to the chunk and their doors are hashed from the seam's coordinate, with at
+// least one door per seam, so every chunk connects to all four neighbours.
+// The Tilemap shows a WINDOW_CHUNKS square window of the world centered on the
+// camera's chunk. follow() moves the window a chunk at a time as the camera
+// crosses chunk edges and hands back the shift, so camera coordinates stay small
+// however far it travels. Chunks further than KEEP_RADIUS from the window center
+// are evicted; memory is bounded by the window and the kept ring.
+class MazeWorld {
+public:
+    static constexpr int CHUNK_CELLS = 16;
+    static constexpr int CHUNK_SIZE = CHUNK_CELLS * 2;       // Tiles per chunk side
+    static constexpr int CHUNK_PIXELS = CHUNK_SIZE * TILE_SIZE;
+    static constexpr int WINDOW_CHUNKS = 3;                  // Odd, so one chunk is the center
+    static constexpr int WINDOW_SIZE = WINDOW_CHUNKS * CHUNK_SIZE;
+    static constexpr int KEEP_RADIUS = WINDOW_CHUNKS / 2 + 1;  // Window plus one ring generated ahead
+
+    struct Stats {
+        uint64_t generated = 0;  // Chunks generated, counting regenerations after eviction
+        uint64_t evicted = 0;
+        uint64_t shifts = 0;     // Window moves
+    };
+
+    // straightness and imperfect shape every chunk; imperfect also adds seam doors
+    explicit MazeWorld(uint32_t seed, const MazeConfig& config = MazeConfig{});
+
+    uint32_t getSeed() const { return seed_; }
+
+    // Show the window centered on chunk (chunkX, chunkY) in map, replacing its
+    // contents. The old map's planes are freed.
+    void enter(Tilemap& map, int chunkX, int chunkY);
+
+    // Once per tick with the view center in map pixels. Generates at most one chunk
+    // ahead of the camera, and when the center has left the window's middle chunk,
+    // recenters the window on it and returns true with the pixels the map moved by;
+    // subtract them from camera positions.
+    bool follow(Tilemap& map, float centerX, float centerY, int& shiftX, int& shiftY);
+
+    // Chunk coordinate of the window's middle chunk
+    int getCenterX() const { return originX_ + WINDOW_CHUNKS / 2; }
+    int getCenterY() const { return originY_ + WINDOW_CHUNKS / 2; }
+
+    size_t getChunkCount() const { return chunks_.size(); }
+    const Stats& getStats() const { return stats_; }
+
+    // Tile types of chunk (chunkX, chunkY), CHUNK_SIZE rows of CHUNK_SIZE, generated if needed
+    const std::vector<uint8_t>& getChunk(int chunkX, int chunkY);
+
+private:
+    struct Chunk {
+        int x;
+        int y;
+        std::vector<uint8_t> types;
+    };
+
+    static uint64_t key(int chunkX, int chunkY) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkY);
+    }
+
+    void generate(int chunkX, int chunkY, std::vector<uint8_t>& types) const;
+    void buildWindow(Tilemap& map);
+    void evictFar();
+    void generateAhead();
+
+    uint32_t seed_;
+    MazeConfig config_;
+    uint32_t doorChance_;  // Extra doors per seam cell, from imperfect
+    std::array<bool, 256> solidTypes_;
+
+    std::unordered_map<uint64_t, Chunk> chunks_;
+    int originX_ = 0;    // Window's top-left chunk
+    int originY_ = 0;
+    TileBuffer window_;  // Next window, built here and swapped into the map
+    Stats stats_;
+};
\ No newline at end of file
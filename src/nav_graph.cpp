@@ -0,0 +1,378 @@
+#include "nav_graph.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+    const int DIRECTION_X[4] = {1, -1, 0, 0};
+    const int DIRECTION_Y[4] = {0, 0, 1, -1};
+
+    using HeapOrder = std::greater<std::pair<int, int>>;
+
+    // Restart lazily-cleared scratch arrays: bump the stamp, wiping only on wraparound
+    void nextStamp(std::vector<uint32_t>& stamps, uint32_t& current, size_t size) {
+        if (stamps.size() != size || ++current == 0) {
+            stamps.assign(size, 0);
+            current = 1;
+        }
+    }
+}
+
+void NavGraph::build(const Tilemap& map) {
+    width_ = map.getWidth();
+    height_ = map.getHeight();
+    revision_ = map.getSolidRevision();
+
+    const size_t count = static_cast<size_t>(width_) * height_;
+    nodes_.clear();
+    edges_.clear();
+    links_.clear();
+    corridorCells_.clear();
+    cellNode_.assign(count, -1);
+    cellEdge_.assign(count, -1);
+    cellStep_.assign(count, 0);
+
+    // Nodes: every open tile that is not a plain corridor tile
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            if (!isOpen(map, x, y)) continue;
+
+            int degree = 0;
+            for (int i = 0; i < 4; ++i) {
+                degree += isOpen(map, x + DIRECTION_X[i], y + DIRECTION_Y[i]);
+            }
+            if (degree != 2) {
+                cellNode_[y * width_ + x] = static_cast<int>(nodes_.size());
+                nodes_.push_back({x, y, 0});
+            }
+        }
+    }
+
+    auto traceAll = [&](int node) {
+        for (int i = 0; i < 4; ++i) {
+            if (isOpen(map, nodes_[node].x + DIRECTION_X[i], nodes_[node].y + DIRECTION_Y[i])) {
+                traceEdge(map, node, DIRECTION_X[i], DIRECTION_Y[i]);
+            }
+        }
+    };
+
+    for (size_t node = 0; node < nodes_.size(); ++node) {
+        traceAll(static_cast<int>(node));
+    }
+
+    // Closed corridor rings have no node yet: promote one of their tiles
+    for (int y = 0; y < height_; ++y) {
+        for (int x = 0; x < width_; ++x) {
+            const int cell = y * width_ + x;
+            if (isOpen(map, x, y) && cellNode_[cell] < 0 && cellEdge_[cell] < 0) {
+                cellNode_[cell] = static_cast<int>(nodes_.size());
+                nodes_.push_back({x, y, 0});
+                traceAll(cellNode_[cell]);
+            }
+        }
+    }
+
+    // Adjacency in one array, grouped by node (rings back to the same node are never shorter)
+    std::vector<int> linkCount(nodes_.size() + 1, 0);
+    for (const Edge& edge : edges_) {
+        if (edge.a != edge.b) {
+            ++linkCount[edge.a];
+            ++linkCount[edge.b];
+        }
+    }
+
+    int total = 0;
+    for (size_t node = 0; node < nodes_.size(); ++node) {
+        nodes_[node].firstLink = total;
+        total += linkCount[node];
+        linkCount[node] = nodes_[node].firstLink;
+    }
+
+    links_.resize(total);
+    for (size_t i = 0; i < edges_.size(); ++i) {
+        const Edge& edge = edges_[i];
+        if (edge.a != edge.b) {
+            links_[linkCount[edge.a]++] = {edge.b, static_cast<int>(i), edge.length};
+            links_[linkCount[edge.b]++] = {edge.a, static_cast<int>(i), edge.length};
+        }
+    }
+}
+
+void NavGraph::traceEdge(const Tilemap& map, int node, int dx, int dy) {
+    int prevX = nodes_[node].x;
+    int prevY = nodes_[node].y;
+    int x = prevX + dx;
+    int y = prevY + dy;
+    int cell = y * width_ + x;
+
+    // Adjacent nodes: a one-step edge, added once from the lower index
+    if (cellNode_[cell] >= 0) {
+        if (cellNode_[cell] > node) {
+            edges_.push_back({node, cellNode_[cell], 1, static_cast<int>(corridorCells_.size())});
+        }
+        return;
+    }
+
+    // Already traced from its other end
+    if (cellEdge_[cell] >= 0) {
+        return;
+    }
+
+    const int edge = static_cast<int>(edges_.size());
+    const int firstCell = static_cast<int>(corridorCells_.size());
+    int step = 1;
+    while (cellNode_[cell] < 0) {
+        cellEdge_[cell] = edge;
+        cellStep_[cell] = step++;
+        corridorCells_.push_back(cell);
+
+        // Corridor tiles have exactly two open neighbors; continue through the one we did not come from
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + DIRECTION_X[i];
+            int ny = y + DIRECTION_Y[i];
+            if ((nx != prevX || ny != prevY) && isOpen(map, nx, ny)) {
+                prevX = x;
+                prevY = y;
+                x = nx;
+                y = ny;
+                break;
+            }
+        }
+        cell = y * width_ + x;
+    }
+
+    edges_.push_back({node, cellNode_[cell], step, firstCell});
+}
+
+int NavGraph::anchors(int cell, Anchor (&out)[2]) const {
+    if (cellNode_[cell] >= 0) {
+        out[0] = {cellNode_[cell], 0};
+        return 1;
+    }
+    if (cellEdge_[cell] >= 0) {
+        const Edge& edge = edges_[cellEdge_[cell]];
+        out[0] = {edge.a, cellStep_[cell]};
+        out[1] = {edge.b, edge.length - cellStep_[cell]};
+        return 2;
+    }
+    return 0;
+}
+
+int NavGraph::findPath(int startX, int startY, int goalX, int goalY, std::vector<NavPoint>* path) {
+    expanded_ = 0;
+    if (path) path->clear();
+    if (startX < 0 || startY < 0 || startX >= width_ || startY >= height_ ||
+        goalX < 0 || goalY < 0 || goalX >= width_ || goalY >= height_) {
+        return -1;
+    }
+
+    const int start = startY * width_ + startX;
+    const int goal = goalY * width_ + goalX;
+    Anchor from[2];
+    Anchor to[2];
+    const int fromCount = anchors(start, from);
+    const int toCount = anchors(goal, to);
+    if (fromCount == 0 || toCount == 0) {
+        return -1;
+    }
+
+    // Both ends in the same corridor: walking along it is a candidate
+    int best = -1;
+    int bestNode = -1;
+    int bestAnchor = -1;
+    const int sharedEdge = cellEdge_[start] >= 0 && cellEdge_[start] == cellEdge_[goal] ? cellEdge_[start] : -1;
+    if (start == goal) {
+        best = 0;
+    } else if (sharedEdge >= 0) {
+        best = std::abs(cellStep_[start] - cellStep_[goal]);
+    }
+
+    // A* over the nodes, seeded with the corridor walk to each start anchor
+    const size_t nodeCount = nodes_.size();
+    nextStamp(stamp_, currentStamp_, nodeCount);
+    gScore_.resize(nodeCount);
+    parent_.resize(nodeCount);
+    parentEdge_.resize(nodeCount);
+    open_.clear();
+
+    auto heuristic = [&](int node) {
+        return std::abs(nodes_[node].x - goalX) + std::abs(nodes_[node].y - goalY);
+    };
+    auto visit = [&](int node, int g, int parent, int edge) {
+        if (stamp_[node] != currentStamp_ || g < gScore_[node]) {
+            stamp_[node] = currentStamp_;
+            gScore_[node] = g;
+            parent_[node] = parent;
+            parentEdge_[node] = edge;
+            open_.push_back({g + heuristic(node), node});
+            std::push_heap(open_.begin(), open_.end(), HeapOrder());
+        }
+    };
+
+    for (int i = 0; i < fromCount && best != 0; ++i) {
+        visit(from[i].node, from[i].cost, -1, -1);
+    }
+
+    while (!open_.empty()) {
+        std::pop_heap(open_.begin(), open_.end(), HeapOrder());
+        const int f = open_.back().first;
+        const int node = open_.back().second;
+        open_.pop_back();
+
+        const int g = gScore_[node];
+        if (f != g + heuristic(node)) continue;  // Superseded entry
+        if (best >= 0 && f >= best) break;
+        ++expanded_;
+
+        for (int i = 0; i < toCount; ++i) {
+            if (to[i].node == node && (best < 0 || g + to[i].cost < best)) {
+                best = g + to[i].cost;
+                bestNode = node;
+                bestAnchor = i;
+            }
+        }
+
+        const int linkEnd = node + 1 < static_cast<int>(nodeCount) ? nodes_[node + 1].firstLink
+                                                                    : static_cast<int>(links_.size());
+        for (int i = nodes_[node].firstLink; i < linkEnd; ++i) {
+            visit(links_[i].node, g + links_[i].length, node, links_[i].edge);
+        }
+    }
+
+    if (!path || best < 0) {
+        return best;
+    }
+
+    // Expand the corridors: start tile to first node, node chain, last node to goal
+    if (bestNode < 0) {
+        if (sharedEdge >= 0) {
+            appendCorridor(*path, sharedEdge, cellStep_[start], cellStep_[goal]);
+        } else {
+            appendCell(*path, start);
+        }
+        return best;
+    }
+
+    std::vector<int>& chain = chain_;
+    chain.clear();
+    for (int node = bestNode; node >= 0; node = parent_[node]) {
+        chain.push_back(node);
+    }
+    std::reverse(chain.begin(), chain.end());
+
+    if (cellEdge_[start] >= 0) {
+        const Edge& edge = edges_[cellEdge_[start]];
+        const bool towardA = chain[0] == edge.a && (edge.a != edge.b || cellStep_[start] == gScore_[chain[0]]);
+        appendCorridor(*path, cellEdge_[start], cellStep_[start], towardA ? 0 : edge.length);
+    } else {
+        appendCell(*path, start);
+    }
+
+    for (size_t i = 1; i < chain.size(); ++i) {
+        const Edge& edge = edges_[parentEdge_[chain[i]]];
+        if (edge.a == chain[i - 1]) {
+            appendCorridor(*path, parentEdge_[chain[i]], 1, edge.length);
+        } else {
+            appendCorridor(*path, parentEdge_[chain[i]], edge.length - 1, 0);
+        }
+    }
+
+    if (cellEdge_[goal] >= 0) {
+        const Edge& edge = edges_[cellEdge_[goal]];
+        if (bestAnchor == 0) {
+            appendCorridor(*path, cellEdge_[goal], 1, cellStep_[goal]);
+        } else {
+            appendCorridor(*path, cellEdge_[goal], edge.length - 1, cellStep_[goal]);
+        }
+    }
+    return best;
+}
+
+void NavGraph::appendCorridor(std::vector<NavPoint>& path, int edge, int fromStep, int toStep) const {
+    // Step 0 is node a, step length is node b, the steps between are corridor tiles
+    const Edge& e = edges_[edge];
+    const int direction = toStep >= fromStep ? 1 : -1;
+    for (int step = fromStep; step != toStep + direction; step += direction) {
+        if (step == 0) {
+            path.push_back({nodes_[e.a].x, nodes_[e.a].y});
+        } else if (step == e.length) {
+            path.push_back({nodes_[e.b].x, nodes_[e.b].y});
+        } else {
+            appendCell(path, corridorCells_[e.firstCell + step - 1]);
+        }
+    }
+}
+
+void NavGraph::appendCell(std::vector<NavPoint>& path, int cell) const {
+    path.push_back({cell % width_, cell / width_});
+}
+
+int GridAStar::findPath(const Tilemap& map, int startX, int startY, int goalX, int goalY,
+                        std::vector<NavPoint>* path) {
+    expanded_ = 0;
+    if (path) path->clear();
+
+    const int width = map.getWidth();
+    const int height = map.getHeight();
+    auto open = [&](int x, int y) { return map.isValidPosition(x, y) && !map.isSolid(x, y); };
+    if (!open(startX, startY) || !open(goalX, goalY)) {
+        return -1;
+    }
+
+    const size_t count = static_cast<size_t>(width) * height;
+    nextStamp(stamp_, currentStamp_, count);
+    gScore_.resize(count);
+    parent_.resize(count);
+    open_.clear();
+
+    auto heuristic = [&](int cell) {
+        return std::abs(cell % width - goalX) + std::abs(cell / width - goalY);
+    };
+
+    const int start = startY * width + startX;
+    const int goal = goalY * width + goalX;
+    stamp_[start] = currentStamp_;
+    gScore_[start] = 0;
+    parent_[start] = -1;
+    open_.push_back({heuristic(start), start});
+
+    int result = -1;
+    while (!open_.empty()) {
+        std::pop_heap(open_.begin(), open_.end(), HeapOrder());
+        const int f = open_.back().first;
+        const int cell = open_.back().second;
+        open_.pop_back();
+
+        const int g = gScore_[cell];
+        if (f != g + heuristic(cell)) continue;  // Superseded entry
+        ++expanded_;
+
+        if (cell == goal) {
+            result = g;
+            break;
+        }
+
+        const int x = cell % width;
+        const int y = cell / width;
+        for (int i = 0; i < 4; ++i) {
+            int nx = x + DIRECTION_X[i];
+            int ny = y + DIRECTION_Y[i];
+            int neighbor = ny * width + nx;
+            if (open(nx, ny) && (stamp_[neighbor] != currentStamp_ || g + 1 < gScore_[neighbor])) {
+                stamp_[neighbor] = currentStamp_;
+                gScore_[neighbor] = g + 1;
+                parent_[neighbor] = cell;
+                open_.push_back({g + 1 + heuristic(neighbor), neighbor});
+                std::push_heap(open_.begin(), open_.end(), HeapOrder());
+            }
+        }
+    }
+
+    if (path && result >= 0) {
+        for (int cell = goal; cell >= 0; cell = parent_[cell]) {
+            path->push_back({cell % width, cell / width});
+        }
+        std::reverse(path->begin(), path->end());
+    }
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "tilemap.h"
+
+struct NavPoint {
+    int x;
+    int y;
+};
+
+// Navigation graph over a tilemap's open tiles.
+// Generated mazes are mostly 1-wide corridors, so tiles with exactly two open
+// neighbors are folded into weighted edges between nodes (junctions, dead ends and
+// anything else that is not a plain corridor). Path queries search the nodes and
+// only walk the corridors that hold the start and goal. Movement is 4-connected and
+// every step costs 1, the same as FlowField and GridAStar.
+class NavGraph {
+public:
+    // Collapse the open tiles of map; call again after loading a map
+    void build(const Tilemap& map);
+
+    // The map's solidity changed since build()
+    bool isStale(const Tilemap& map) const { return map.getSolidRevision() != revision_; }
+
+    // Shortest path length in steps, or -1 if unreachable. path (optional) receives
+    // every tile from start to goal inclusive.
+    int findPath(int startX, int startY, int goalX, int goalY, std::vector<NavPoint>* path = nullptr);
+
+    size_t getNodeCount() const { return nodes_.size(); }
+    size_t getEdgeCount() const { return edges_.size(); }
+    size_t getLastExpanded() const { return expanded_; }  // Nodes popped by the last query
+
+private:
+    struct Node {
+        int x;
+        int y;
+        int firstLink;  // Range into links_, ends at the next node's firstLink
+    };
+
+    // A corridor between nodes a and b: length steps, length - 1 corridor tiles
+    struct Edge {
+        int a;
+        int b;
+        int length;
+        int firstCell;  // Corridor tiles in corridorCells_, ordered from a to b
+    };
+
+    struct Link {
+        int node;
+        int edge;
+        int length;
+    };
+
+    // Where a tile enters the graph: a node, with the steps to reach it
+    struct Anchor {
+        int node;
+        int cost;
+    };
+
+    int width_ = 0;
+    int height_ = 0;
+    uint64_t revision_ = 0;
+    std::vector<Node> nodes_;
+    std::vector<Edge> edges_;
+    std::vector<Link> links_;
+    std::vector<int> corridorCells_;
+    std::vector<int> cellNode_;  // Node index per tile, or -1
+    std::vector<int> cellEdge_;  // Edge index per corridor tile, or -1
+    std::vector<int> cellStep_;  // Steps from the edge's node a
+
+    // Query scratch, reset lazily through visit stamps
+    std::vector<int> gScore_;
+    std::vector<int> parent_;       // Previous node, -1 for a start anchor
+    std::vector<int> parentEdge_;
+    std::vector<uint32_t> stamp_;
+    uint32_t currentStamp_ = 0;
+    std::vector<std::pair<int, int>> open_;  // (f, node) min-heap
+    std::vector<int> chain_;                 // Node sequence of the found path
+    size_t expanded_ = 0;
+
+    bool isOpen(const Tilemap& map, int x, int y) const {
+        return map.isValidPosition(x, y) && !map.isSolid(x, y);
+    }
+    int anchors(int cell, Anchor (&out)[2]) const;
+    void traceEdge(const Tilemap& map, int node, int dx, int dy);
+    void appendCorridor(std::vector<NavPoint>& path, int edge, int fromStep, int toStep) const;
+    void appendCell(std::vector<NavPoint>& path, int cell) const;
+};
+
+// Plain 4-connected grid A*, the baseline NavGraph is measured against
+class GridAStar {
+public:
+    int findPath(const Tilemap& map, int startX, int startY, int goalX, int goalY,
+                 std::vector<NavPoint>* path = nullptr);
+    size_t getLastExpanded() const { return expanded_; }
+
+private:
+    std::vector<int> gScore_;
+    std::vector<int> parent_;
+    std::vector<uint32_t> stamp_;
+    uint32_t currentStamp_ = 0;
+    std::vector<std::pair<int, int>> open_;
+    size_t expanded_ = 0;
+};
\ No newline at end of file
@@ -0,0 +1,172 @@
+#include "profiler.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+Profiler profiler;
+
+namespace {
+    // 3x5 pixel glyphs, one bit per pixel, rows top to bottom (bit 14 = top left)
+    const char GLYPH_CHARS[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ.:-/_";
+    const uint16_t GLYPHS[] = {
+        0x7b6f, 0x2c97, 0x73e7, 0x73cf, 0x5bc9, 0x79cf, 0x79ef, 0x7249, 0x7bef, 0x7bcf,
+        0x2bed, 0x6bae, 0x3923, 0x6b6e, 0x79a7, 0x79a4, 0x396b, 0x5bed, 0x7497, 0x126a,
+        0x5bad, 0x4927, 0x5fed, 0x6b6d, 0x2b6a, 0x6ba4, 0x2b73, 0x6bad, 0x388e, 0x7492,
+        0x5b6f, 0x5b6a, 0x5bfd, 0x5aad, 0x5a92, 0x72a7, 0x0002, 0x0410, 0x01c0, 0x12a4,
+        0x0007,
+    };
+
+    const int PIXEL = 2;                  // Screen pixels per font pixel
+    const int CHAR_WIDTH = 4 * PIXEL;     // Glyph plus one pixel of spacing
+    const int LINE_HEIGHT = 7 * PIXEL;
+    const int NAME_COLUMNS = 16;
+    const int VALUE_COLUMNS = 8;
+    const int BAR_WIDTH = 80;
+    const double BAR_FULL_MS = 1000.0 / 60.0;  // A full bar is one 60 Hz frame
+
+    // Append the pixels of text to rects; unknown characters are blank
+    void appendText(std::vector<SDL_Rect>& rects, const char* text, int x, int y) {
+        for (; *text; ++text, x += CHAR_WIDTH) {
+            const char* found = std::strchr(GLYPH_CHARS, std::toupper(static_cast<unsigned char>(*text)));
+            if (!found) continue;
+
+            uint16_t glyph = GLYPHS[found - GLYPH_CHARS];
+            for (int bit = 0; bit < 15; ++bit) {
+                if (glyph & (1 << (14 - bit))) {
+                    rects.push_back({x + (bit % 3) * PIXEL, y + (bit / 3) * PIXEL, PIXEL, PIXEL});
+                }
+            }
+        }
+    }
+}
+
+Profiler::Profiler()
+    : origin_(Clock::now()), nextEvent_(0), eventCount_(0), frameDrawCalls_(0), drawCallSum_(0),
+      historyIndex_(0), historyFrames_(0) {
+}
+
+int Profiler::registerScope(const char* name) {
+    for (size_t i = 0; i < scopes_.size(); ++i) {
+        if (std::strcmp(scopes_[i].name, name) == 0) {
+            return static_cast<int>(i);
+        }
+    }
+
+    Scope scope;
+    scope.name = name;
+    scopes_.push_back(scope);
+    return static_cast<int>(scopes_.size() - 1);
+}
+
+void Profiler::record(int scope, Clock::time_point start, Clock::time_point end) {
+    const int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start - origin_).count();
+    const int64_t durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    scopes_[scope].frameMilliseconds += durationNs / 1e6;
+
+    if (events_.empty()) {
+        events_.resize(TRACE_CAPACITY);
+    }
+    events_[nextEvent_] = {scope, startNs, durationNs};
+    nextEvent_ = (nextEvent_ + 1) % TRACE_CAPACITY;
+    eventCount_ = std::min(eventCount_ + 1, TRACE_CAPACITY);
+}
+
+void Profiler::endFrame() {
+    for (Scope& scope : scopes_) {
+        const float milliseconds = static_cast<float>(scope.frameMilliseconds);
+        scope.historySum += milliseconds - scope.history[historyIndex_];
+        scope.history[historyIndex_] = milliseconds;
+        scope.frameMilliseconds = 0.0;
+    }
+
+    drawCallSum_ += frameDrawCalls_ - drawCallHistory_[historyIndex_];
+    drawCallHistory_[historyIndex_] = frameDrawCalls_;
+    frameDrawCalls_ = 0;
+
+    historyIndex_ = (historyIndex_ + 1) % HISTORY_FRAMES;
+    historyFrames_ = std::min(historyFrames_ + 1, HISTORY_FRAMES);
+}
+
+double Profiler::averageMilliseconds(int scope) const {
+    return historyFrames_ ? std::max(0.0, scopes_[scope].historySum) / historyFrames_ : 0.0;
+}
+
+double Profiler::averageDrawCalls() const {
+    return historyFrames_ ? static_cast<double>(drawCallSum_) / historyFrames_ : 0.0;
+}
+
+bool Profiler::writeTrace(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) {
+        std::cout << "Error: Could not write trace file: " << filename << std::endl;
+        return false;
+    }
+
+    // Complete ("X") events on one thread; the viewer nests them by time
+    file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    const size_t first = (nextEvent_ + TRACE_CAPACITY - eventCount_) % TRACE_CAPACITY;
+    char line[256];
+    for (size_t i = 0; i < eventCount_; ++i) {
+        const Event& event = events_[(first + i) % TRACE_CAPACITY];
+        std::snprintf(line, sizeof(line),
+                      "%s{\"name\": \"%s\", \"cat\": \"crossroads\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                      "\"pid\": 1, \"tid\": 1}",
+                      i == 0 ? "" : ",\n", scopes_[event.scope].name, event.start / 1000.0, event.duration / 1000.0);
+        file << line;
+    }
+    file << "\n]}\n";
+
+    if (!file) {
+        std::cout << "Error: Could not write trace file: " << filename << std::endl;
+        return false;
+    }
+    std::cout << "Wrote " << eventCount_ << " trace events to " << filename << std::endl;
+    return true;
+}
+
+void Profiler::renderOverlay(SDL_Renderer* renderer, int x, int y) const {
+    const int lines = getScopeCount() + 1;
+    const int padding = 4;
+    SDL_Rect background = {x, y, (NAME_COLUMNS + VALUE_COLUMNS) * CHAR_WIDTH + BAR_WIDTH + padding * 3,
+                           lines * LINE_HEIGHT + padding * 2};
+
+    Uint8 r, g, b, a;
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_GetRenderDrawBlendMode(renderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 192);
+    SDL_RenderFillRect(renderer, &background);
+
+    // All text in one call, all bars in another
+    std::vector<SDL_Rect> text;
+    std::vector<SDL_Rect> bars;
+    char value[32];
+    int lineY = y + padding;
+    const int valueX = x + padding + NAME_COLUMNS * CHAR_WIDTH;
+    const int barX = valueX + VALUE_COLUMNS * CHAR_WIDTH + padding;
+    for (int i = 0; i < getScopeCount(); ++i, lineY += LINE_HEIGHT) {
+        const double milliseconds = averageMilliseconds(i);
+        appendText(text, scopes_[i].name, x + padding, lineY);
+        std::snprintf(value, sizeof(value), "%.3f", milliseconds);
+        appendText(text, value, valueX, lineY);
+
+        int width = static_cast<int>(std::min(1.0, milliseconds / BAR_FULL_MS) * BAR_WIDTH);
+        bars.push_back({barX, lineY, std::max(1, width), 5 * PIXEL});
+    }
+    appendText(text, "draw calls", x + padding, lineY);
+    std::snprintf(value, sizeof(value), "%.0f", averageDrawCalls());
+    appendText(text, value, valueX, lineY);
+
+    SDL_SetRenderDrawColor(renderer, 80, 200, 120, 255);
+    SDL_RenderFillRects(renderer, bars.data(), static_cast<int>(bars.size()));
+    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
+    SDL_RenderFillRects(renderer, text.data(), static_cast<int>(text.size()));
+    PROFILE_DRAW_CALLS(3);
+
+    SDL_SetRenderDrawBlendMode(renderer, blendMode);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+}
\ No newline at end of file
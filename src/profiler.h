@@ -0,0 +1,106 @@
+#pragma once
+
+#include <SDL2/SDL.h>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped wall-clock timers for the main thread.
+// PROFILE_SCOPE("name") times the rest of the enclosing block,
+// PROFILE_DRAW_CALLS(n) counts SDL draw calls and PROFILE_END_FRAME() closes a
+// frame. They expand to nothing unless CROSSROADS_PROFILING is defined (CMake
+// option of the same name), so regular builds carry no timing code at all.
+//
+// Each frame's per-scope totals feed a rolling average for the overlay; scope
+// times include nested scopes. Every timed scope is also kept in a ring of
+// trace events that writeTrace() saves as Chrome trace_event JSON (open it in
+// chrome://tracing or Perfetto).
+class Profiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int HISTORY_FRAMES = 120;          // Rolling window for the overlay
+    static constexpr size_t TRACE_CAPACITY = 1 << 18;   // Most recent events kept for traces
+
+    Profiler();
+
+    // Index for a scope name (a string literal); PROFILE_SCOPE caches it per call site
+    int registerScope(const char* name);
+
+    void record(int scope, Clock::time_point start, Clock::time_point end);
+    void addDrawCalls(int count) { frameDrawCalls_ += count; }
+
+    // Close the current frame: fold its totals into the rolling averages
+    void endFrame();
+
+    // Per-frame averages over the last HISTORY_FRAMES frames
+    int getScopeCount() const { return static_cast<int>(scopes_.size()); }
+    const char* getScopeName(int scope) const { return scopes_[scope].name; }
+    double averageMilliseconds(int scope) const;
+    double averageDrawCalls() const;
+
+    // Save the buffered events as Chrome trace_event JSON
+    bool writeTrace(const std::string& filename) const;
+
+    // Scope averages and draw calls with bars, top-left at (x, y), in a built-in font
+    void renderOverlay(SDL_Renderer* renderer, int x, int y) const;
+
+private:
+    struct Scope {
+        const char* name;
+        double frameMilliseconds = 0.0;  // Total in the current frame
+        std::array<float, HISTORY_FRAMES> history{};
+        double historySum = 0.0;
+    };
+
+    // One timed scope instance, in nanoseconds since the profiler started
+    struct Event {
+        int scope;
+        int64_t start;
+        int64_t duration;
+    };
+
+    Clock::time_point origin_;
+    std::vector<Scope> scopes_;
+    std::vector<Event> events_;  // Ring buffer, allocated on first use
+    size_t nextEvent_;
+    size_t eventCount_;
+
+    int frameDrawCalls_;
+    std::array<int, HISTORY_FRAMES> drawCallHistory_{};
+    int64_t drawCallSum_;
+    int historyIndex_;
+    int historyFrames_;  // Frames in the window so far (up to HISTORY_FRAMES)
+};
+
+extern Profiler profiler;
+
+// Records the time between construction and destruction
+class ProfileScope {
+public:
+    explicit ProfileScope(int scope) : scope_(scope), start_(Profiler::Clock::now()) {}
+    ~ProfileScope() { profiler.record(scope_, start_, Profiler::Clock::now()); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    int scope_;
+    Profiler::Clock::time_point start_;
+};
+
+#ifdef CROSSROADS_PROFILING
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) \
+    static const int PROFILE_CONCAT(profileScopeId_, __LINE__) = profiler.registerScope(name); \
+    ProfileScope PROFILE_CONCAT(profileScope_, __LINE__)(PROFILE_CONCAT(profileScopeId_, __LINE__))
+#define PROFILE_DRAW_CALLS(count) profiler.addDrawCalls(count)
+#define PROFILE_END_FRAME() profiler.endFrame()
+#else
+#define PROFILE_SCOPE(name) ((void)0)
+#define PROFILE_DRAW_CALLS(count) ((void)0)
+#define PROFILE_END_FRAME() ((void)0)
+#endif
\ No newline at end of file
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <random>
+
+// Random engines usable as the MazeGenerator RNG policy.
+// An engine provides seed(uint64_t) and a uint32_t next(). The range helpers below
+// map raw output the same way everywhere; std:: distributions are
+// implementation-defined and differ between libstdc++, libc++ and Emscripten.
+
+// PCG32 (XSH-RR variant), 8 bytes of state. The default engine.
+class Pcg32 {
+public:
+    explicit Pcg32(uint64_t value = 0) { seed(value); }
+
+    void seed(uint64_t value) {
+        state_ = 0;
+        next();
+        state_ += value;
+        next();
+    }
+
+    uint32_t next() {
+        uint64_t old = state_;
+        state_ = old * 6364136223846793005ULL + INCREMENT;
+        uint32_t xorShifted = static_cast<uint32_t>(((old >> 18u) ^ old) >> 27u);
+        uint32_t rotation = static_cast<uint32_t>(old >> 59u);
+        return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+    }
+
+private:
+    static constexpr uint64_t INCREMENT = 1442695040888963407ULL;
+    uint64_t state_ = 0;
+};
+
+// xoshiro128++, 16 bytes of state
+class Xoshiro128 {
+public:
+    explicit Xoshiro128(uint64_t value = 0) { seed(value); }
+
+    void seed(uint64_t value) {
+        // Expand the seed with splitmix64 so nearby seeds give unrelated states
+        for (int i = 0; i < 4; i += 2) {
+            value += 0x9E3779B97F4A7C15ULL;
+            uint64_t z = value;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            z ^= z >> 31;
+            state_[i] = static_cast<uint32_t>(z);
+            state_[i + 1] = static_cast<uint32_t>(z >> 32);
+        }
+    }
+
+    uint32_t next() {
+        uint32_t result = rotl(state_[0] + state_[3], 7) + state_[0];
+        uint32_t t = state_[1] << 9;
+        state_[2] ^= state_[0];
+        state_[3] ^= state_[1];
+        state_[1] ^= state_[2];
+        state_[0] ^= state_[3];
+        state_[2] ^= t;
+        state_[3] = rotl(state_[3], 11);
+        return result;
+    }
+
+private:
+    static uint32_t rotl(uint32_t x, int k) { return (x << k) | (x >> (32 - k)); }
+    uint32_t state_[4];
+};
+
+// std::mt19937 behind the same interface; its raw output is specified by the
+// standard, so it is portable once the range mapping below is used
+class MersenneTwister {
+public:
+    explicit MersenneTwister(uint64_t value = 0) { seed(value); }
+
+    void seed(uint64_t value) { engine_.seed(static_cast<uint32_t>(value)); }
+    uint32_t next() { return static_cast<uint32_t>(engine_()); }
+
+private:
+    std::mt19937 engine_;
+};
+
+// Uniform integer in [0, bound), bound > 0 (Lemire's multiply-shift with rejection, unbiased)
+template<class Rng>
+inline uint32_t randomBelow(Rng& rng, uint32_t bound) {
+    uint64_t product = static_cast<uint64_t>(rng.next()) * bound;
+    uint32_t low = static_cast<uint32_t>(product);
+    if (low < bound) {
+        uint32_t threshold = (0u - bound) % bound;
+        while (low < threshold) {
+            product = static_cast<uint64_t>(rng.next()) * bound;
+            low = static_cast<uint32_t>(product);
+        }
+    }
+    return static_cast<uint32_t>(product >> 32);
+}
+
+// Uniform float in [0, 1) from the top 24 bits
+template<class Rng>
+inline float randomUnit(Rng& rng) {
+    return (rng.next() >> 8) * (1.0f / 16777216.0f);
+}
+
+// Probability as a 24-bit threshold for randomChance; convert once outside hot loops
+inline uint32_t chanceThreshold(float probability) {
+    if (probability <= 0.0f) return 0;
+    if (probability >= 1.0f) return 1u << 24;
+    return static_cast<uint32_t>(std::ceil(probability * 16777216.0f));
+}
+
+// True with the probability encoded by chanceThreshold (same as randomUnit(rng) < p)
+template<class Rng>
+inline bool randomChance(Rng& rng, uint32_t threshold) {
+    return (rng.next() >> 8) < threshold;
+}
\ No newline at end of file
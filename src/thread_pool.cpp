@@ -0,0 +1,148 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+namespace {
+    // Index of the pool worker running on this thread, or -1 for outside threads
+    thread_local int currentWorker = -1;
+    thread_local const ThreadPool* currentPool = nullptr;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+#ifndef __EMSCRIPTEN__
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+#else
+    (void)threadCount;
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    signal_.notify_all();
+
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    if (threads_.empty()) {
+        ++pending_;
+        runTask(task);
+        return;
+    }
+
+    unsigned index;
+    if (currentPool == this && currentWorker >= 0) {
+        index = static_cast<unsigned>(currentWorker);
+    } else {
+        index = nextQueue_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+    }
+
+    ++pending_;
+    {
+        std::lock_guard<std::mutex> lock(queues_[index]->mutex);
+        queues_[index]->tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++queued_;
+    }
+    signal_.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::function<void()> task;
+    while (pending_ > 0) {
+        if (stealTask(0, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        signal_.wait(lock, [this] { return pending_ == 0 || queued_ > 0; });
+    }
+
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::workerLoop(unsigned index) {
+    currentWorker = static_cast<int>(index);
+    currentPool = this;
+
+    std::function<void()> task;
+    while (true) {
+        if (popTask(index, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        signal_.wait(lock, [this] { return stopping_ || queued_ > 0; });
+        if (stopping_ && queued_ == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::popTask(unsigned index, std::function<void()>& task) {
+    Queue& own = *queues_[index];
+    {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            --queued_;
+            return true;
+        }
+    }
+    return stealTask(index + 1, task);
+}
+
+bool ThreadPool::stealTask(unsigned start, std::function<void()>& task) {
+    const size_t count = queues_.size();
+    for (size_t i = 0; i < count; ++i) {
+        Queue& victim = *queues_[(start + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            --queued_;
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::runTask(std::function<void()>& task) {
+    try {
+        task();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(errorMutex_);
+        if (!error_) {
+            error_ = std::current_exception();
+        }
+    }
+    task = nullptr;
+
+    if (--pending_ == 0) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        signal_.notify_all();
+    }
+}
\ No newline at end of file
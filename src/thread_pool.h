@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool.
+// Every worker owns a deque: it pops its own newest task first and steals the
+// oldest task from another worker when it runs dry. Tasks submitted from inside a
+// task go to the submitting worker's deque, so nested work stays local.
+// Builds without thread support (Emscripten) run every task inline in submit().
+class ThreadPool {
+public:
+    // threadCount 0 = one worker per hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+
+    // Block until every submitted task has finished; the caller helps run tasks.
+    // Rethrows the first exception thrown by a task, if any.
+    void wait();
+
+    unsigned size() const { return static_cast<unsigned>(threads_.size()); }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void workerLoop(unsigned index);
+    bool popTask(unsigned index, std::function<void()>& task);
+    bool stealTask(unsigned start, std::function<void()>& task);
+    void runTask(std::function<void()>& task);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex mutex_;
+    std::condition_variable signal_;
+    std::atomic<size_t> queued_{0};   // Tasks sitting in a deque
+    std::atomic<size_t> pending_{0};  // Tasks submitted but not finished
+    std::atomic<unsigned> nextQueue_{0};
+    bool stopping_ = false;
+
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+};
\ No newline at end of file
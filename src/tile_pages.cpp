@@ -0,0 +1,195 @@
+#include "tile_pages.h"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+    constexpr uint8_t EMPTY_TYPE = static_cast<uint8_t>(TileType::EMPTY);
+}
+
+void TilePages::reset(int width, int height, const std::array<bool, 256>& solidTypes) {
+    file_.close();
+    view_ = MapFormat::View();
+    solidTypes_ = solidTypes;
+    clearPages(width, height, EMPTY);
+}
+
+bool TilePages::open(const std::string& path) {
+    reset(0, 0, solidTypes_);
+    if (!file_.open(path)) {
+        std::cout << "Error: Could not open map file: " << path << std::endl;
+        return false;
+    }
+
+    // The checksum would read every page up front
+    if (!MapFormat::viewBinary(file_, path, view_, false)) {
+        file_.close();
+        view_ = MapFormat::View();
+        return false;
+    }
+
+    view_.solidTypes(solidTypes_);
+    clearPages(view_.width, view_.height, NOT_LOADED);
+    return true;
+}
+
+void TilePages::setBudget(size_t bytes) {
+    budget_ = bytes;
+    evictDownTo(budget_);
+}
+
+const TilePages::Page* TilePages::read(int pageX, int pageY) {
+    const size_t index = static_cast<size_t>(pageY) * pagesX_ + pageX;
+    if (table_[index] == NOT_LOADED && !pageIn(index)) {
+        return nullptr;
+    }
+    if (table_[index] == EMPTY) {
+        return nullptr;
+    }
+
+    Page& page = *resident_[table_[index]];
+    touch(page);
+    return &page;
+}
+
+TilePages::Page& TilePages::write(int pageX, int pageY) {
+    const size_t index = static_cast<size_t>(pageY) * pagesX_ + pageX;
+    if (table_[index] == NOT_LOADED) {
+        pageIn(index);
+    }
+
+    Page& page = table_[index] == EMPTY ? allocate(index) : *resident_[table_[index]];
+    if (!page.dirty) {
+        page.dirty = true;
+        lru_.erase(page.lru);
+    }
+    lastTouched_ = index;
+    return page;
+}
+
+void TilePages::fill(uint8_t type, bool solid) {
+    reset(width_, height_, solidTypes_);
+    if (type == EMPTY_TYPE && !solid) {
+        return;
+    }
+
+    for (int pageY = 0; pageY < pagesY_; ++pageY) {
+        for (int pageX = 0; pageX < pagesX_; ++pageX) {
+            Page& page = write(pageX, pageY);
+            page.types.fill(type);
+            if (solid) {
+                const int columns = std::min(PAGE_SIZE, width_ - pageX * PAGE_SIZE);
+                const uint64_t bits = columns == PAGE_SIZE ? ~uint64_t(0) : (uint64_t(1) << columns) - 1;
+                const int rows = std::min(PAGE_SIZE, height_ - pageY * PAGE_SIZE);
+                std::fill(page.solid.begin(), page.solid.begin() + rows, bits);
+            }
+        }
+    }
+}
+
+void TilePages::clearPages(int width, int height, int32_t state) {
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    pagesX_ = (width_ + PAGE_SIZE - 1) / PAGE_SIZE;
+    pagesY_ = (height_ + PAGE_SIZE - 1) / PAGE_SIZE;
+    table_.assign(static_cast<size_t>(pagesX_) * pagesY_, state);
+    resident_.clear();
+    freeSlots_.clear();
+    lru_.clear();
+    lastTouched_ = SIZE_MAX;
+}
+
+TilePages::Page& TilePages::allocate(size_t index) {
+    int32_t slot;
+    if (!freeSlots_.empty()) {
+        slot = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        slot = static_cast<int32_t>(resident_.size());
+        resident_.emplace_back();
+    }
+
+    resident_[slot] = std::make_unique<Page>();
+    Page& page = *resident_[slot];
+    page.index = index;
+    table_[index] = slot;
+    lru_.push_front(index);
+    page.lru = lru_.begin();
+    lastTouched_ = index;
+
+    // The new page is the most recent, so it survives
+    evictDownTo(budget_);
+    return page;
+}
+
+bool TilePages::pageIn(size_t index) {
+    Page& page = allocate(index);
+    const int x0 = static_cast<int>(index % pagesX_) * PAGE_SIZE;
+    const int y0 = static_cast<int>(index / pagesX_) * PAGE_SIZE;
+    const int columns = std::min(PAGE_SIZE, width_ - x0);
+    const int rows = std::min(PAGE_SIZE, height_ - y0);
+
+    bool empty = true;
+    for (int y = 0; y < rows; ++y) {
+        const size_t offset = static_cast<size_t>(y0 + y) * width_ + x0;
+        const uint8_t* types = view_.types + offset;
+        uint8_t* out = page.types.data() + y * PAGE_SIZE;
+        uint64_t bits = 0;
+        for (int x = 0; x < columns; ++x) {
+            out[x] = types[x];
+            bits |= static_cast<uint64_t>(solidTypes_[types[x]]) << x;
+            empty = empty && types[x] == EMPTY_TYPE;
+        }
+        page.solid[y] = bits;
+        empty = empty && bits == 0;
+
+        if (view_.variants) {
+            const uint8_t* variants = view_.variants + offset;
+            uint8_t* variantsOut = page.variants.data() + y * PAGE_SIZE;
+            for (int x = 0; x < columns; ++x) {
+                variantsOut[x] = variants[x];
+                empty = empty && variants[x] == 0;
+            }
+        }
+    }
+
+    if (empty) {
+        release(page, EMPTY);
+        ++stats_.emptyPages;
+        return false;
+    }
+    ++stats_.pageIns;
+    return true;
+}
+
+void TilePages::release(Page& page, int32_t state) {
+    if (!page.dirty) {
+        lru_.erase(page.lru);
+    }
+    if (lastTouched_ == page.index) {
+        lastTouched_ = SIZE_MAX;
+    }
+
+    const int32_t slot = table_[page.index];
+    table_[page.index] = state;
+    freeSlots_.push_back(slot);
+    resident_[slot].reset();
+}
+
+void TilePages::touch(Page& page) {
+    if (page.index == lastTouched_) {
+        return;
+    }
+    lastTouched_ = page.index;
+    if (!page.dirty) {
+        lru_.splice(lru_.begin(), lru_, page.lru);
+    }
+}
+
+void TilePages::evictDownTo(size_t bytes) {
+    // Only clean pages can go, and never the most recent: it is the one being read
+    while (getBytes() > bytes && lru_.size() > 1) {
+        Page& page = *resident_[table_[lru_.back()]];
+        release(page, NOT_LOADED);
+        ++stats_.evictions;
+    }
+}
\ No newline at end of file
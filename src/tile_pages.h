@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+#include "map_format.h"
+
+// Sparse tile storage behind Tilemap's paged mode, for maps larger than memory.
+// Tiles live in PAGE_SIZE square pages found through a page table. A page only
+// takes memory once it holds something: pages that are all empty (never written,
+// or empty in the file) cost one table entry. A map opened from a binary file is
+// memory mapped and pages are copied in the first time a tile on them is read;
+// clean pages are evicted least recently used once resident pages pass the byte
+// budget, and come back from the file when needed again. Written pages cannot
+// come back from the file, so they are pinned until the map is replaced.
+// Pages are PAGE_SIZE tiles wide so each page row's solidity is one bitmap word,
+// as in Tilemap's dense bitmap. Not thread-safe; reads may page in.
+class TilePages {
+public:
+    static constexpr int PAGE_SIZE = 64;
+    static constexpr int PAGE_TILES = PAGE_SIZE * PAGE_SIZE;
+    static constexpr size_t DEFAULT_BUDGET = size_t(64) << 20;
+
+    struct Page {
+        std::array<uint8_t, PAGE_TILES> types{};
+        std::array<uint8_t, PAGE_TILES> variants{};
+        std::array<uint64_t, PAGE_SIZE> solid{};  // Bit x of word y is tile (x, y); bits past the map edge stay clear
+        size_t index = 0;                         // Page table entry
+        bool dirty = false;                       // Written since paged in, so pinned
+        std::list<size_t>::iterator lru;          // Position in the LRU list while clean
+    };
+
+    struct Stats {
+        size_t pageIns = 0;     // Pages copied in from the file
+        size_t evictions = 0;
+        size_t emptyPages = 0;  // File pages found empty and dropped instead of kept
+    };
+
+    // Empty map without a file: every page starts empty and is created when written
+    void reset(int width, int height, const std::array<bool, 256>& solidTypes);
+
+    // Map backed by a binary map file (full path); nothing is read until tiles are.
+    // Errors go to stdout.
+    bool open(const std::string& path);
+
+    // Evicts clean pages down to the new budget
+    void setBudget(size_t bytes);
+    size_t getBudget() const { return budget_; }
+
+    int getWidth() const { return width_; }
+    int getHeight() const { return height_; }
+    int getPagesX() const { return pagesX_; }
+    int getPagesY() const { return pagesY_; }
+
+    // The page, paged in if needed; nullptr if it holds only empty, non-solid tiles.
+    // Valid until the next call that pages in or allocates.
+    const Page* read(int pageX, int pageY);
+
+    // The page for writing: paged in or created empty, and pinned
+    Page& write(int pageX, int pageY);
+
+    // Every page filled with type (dropping the file); empty, non-solid frees them all
+    void fill(uint8_t type, bool solid);
+
+    size_t getResidentPages() const { return resident_.size() - freeSlots_.size(); }
+    size_t getPinnedPages() const { return getResidentPages() - lru_.size(); }
+    size_t getBytes() const { return getResidentPages() * sizeof(Page); }
+    const Stats& getStats() const { return stats_; }
+
+private:
+    // Page table entries that are not slots in resident_
+    static constexpr int32_t NOT_LOADED = -1;  // In the file, not read yet
+    static constexpr int32_t EMPTY = -2;       // Known to hold only empty tiles
+
+    void clearPages(int width, int height, int32_t state);
+    Page& allocate(size_t index);
+    bool pageIn(size_t index);
+    void release(Page& page, int32_t state);
+    void touch(Page& page);
+    void evictDownTo(size_t bytes);
+
+    int width_ = 0;
+    int height_ = 0;
+    int pagesX_ = 0;
+    int pagesY_ = 0;
+    std::vector<int32_t> table_;                 // Per page: slot in resident_, NOT_LOADED or EMPTY
+    std::vector<std::unique_ptr<Page>> resident_;
+    std::vector<int32_t> freeSlots_;
+    std::list<size_t> lru_;                      // Clean resident pages (table indices), most recent first
+    size_t lastTouched_ = SIZE_MAX;              // Skips LRU updates for runs on one page
+    size_t budget_ = DEFAULT_BUDGET;
+    Stats stats_;
+
+    MappedFile file_;
+    MapFormat::View view_;
+    std::array<bool, 256> solidTypes_{};
+};
\ No newline at end of file
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+// Tile types
+enum class TileType : uint8_t {
+    EMPTY = 0,
+    FLOOR = 1,
+    
+    // Wall types matching original Crossroads style
+    WALL_BRICK = 2,          // Orange brick wall (main wall type)
+    WALL_TOP = 3,            // Top edge of wall
+    WALL_BOTTOM = 4,         // Bottom edge of wall  
+    WALL_LEFT = 5,           // Left edge of wall
+    WALL_RIGHT = 6,          // Right edge of wall
+    WALL_TOP_LEFT = 7,       // Top-left corner
+    WALL_TOP_RIGHT = 8,      // Top-right corner
+    WALL_BOTTOM_LEFT = 9,    // Bottom-left corner
+    WALL_BOTTOM_RIGHT = 10,  // Bottom-right corner
+    WALL_INNER_TOP_LEFT = 11,     // Inner corner top-left
+    WALL_INNER_TOP_RIGHT = 12,    // Inner corner top-right
+    WALL_INNER_BOTTOM_LEFT = 13,  // Inner corner bottom-left
+    WALL_INNER_BOTTOM_RIGHT = 14, // Inner corner bottom-right
+    
+    // Additional tile types
+    WATER = 15,
+    GRASS = 16,
+    
+    // Add more tile types as needed
+    MAX_TILES = 255
+};
+
+// Default collision rule for tile types (all brick wall pieces are solid)
+inline bool isSolidTileType(TileType type) {
+    return type >= TileType::WALL_BRICK && type <= TileType::WALL_INNER_BOTTOM_RIGHT;
+}
\ No newline at end of file
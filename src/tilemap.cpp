@@ -1,66 +1,415 @@
 #include "tilemap.h"
+#include "map_manifest.h"
+#include "maze_generator.h"
+#include "profiler.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
-#include <filesystem>
+
+namespace {
+    // A 32x32-tile chunk is 512x512 pixels (1 MB as RGBA); 16 covers the visible
+    // 3x2 chunks at 640x400 with room for panning back and forth
+    const size_t DEFAULT_CHUNK_TEXTURE_LIMIT = 16;
+    const int CHUNK_PIXELS = CHUNK_TILES * TILE_SIZE;
+    
+    inline int popcount64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(value);
+#else
+        int count = 0;
+        for (; value; value &= value - 1) ++count;
+        return count;
+#endif
+    }
+    
+    inline int countTrailingZeros64(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(value);
+#else
+        int count = 0;
+        for (; !(value & 1); value >>= 1) ++count;
+        return count;
+#endif
+    }
+    
+    // Solid bitmap rows (stride words each) from a row-major type plane
+    void fillSolidBitmap(const uint8_t* types, int width, int height, int stride,
+                         const std::array<bool, 256>& solidTypes, uint64_t* solid) {
+        for (int y = 0; y < height; ++y) {
+            const uint8_t* typeRow = types + static_cast<size_t>(y) * width;
+            uint64_t* row = solid + static_cast<size_t>(y) * stride;
+            for (int word = 0; word < stride; ++word) {
+                const int first = word * 64;
+                const int count = std::min(64, width - first);
+                uint64_t bits = 0;
+                for (int i = 0; i < count; ++i) {
+                    bits |= uint64_t(solidTypes[typeRow[first + i]]) << i;
+                }
+                row[word] = bits;
+            }
+        }
+    }
+    
+    // Calls f(bits, firstTile) for each word of a bitmap row covering tiles firstX..lastX,
+    // with bits outside that range cleared; bit i is tile firstTile + i. word(i) gives
+    // word i of the row. Stops early and returns true when f does.
+    template<class Word, class F>
+    bool scanBits(Word&& word, int firstX, int lastX, F&& f) {
+        const int firstWord = firstX >> 6;
+        const int lastWord = lastX >> 6;
+        for (int i = firstWord; i <= lastWord; ++i) {
+            uint64_t bits = word(i);
+            if (i == firstWord) bits &= ~uint64_t(0) << (firstX & 63);
+            if (i == lastWord) bits &= ~uint64_t(0) >> (63 - (lastX & 63));
+            if (f(bits, i * 64)) return true;
+        }
+        return false;
+    }
+}
 
 Tilemap::Tilemap(int width, int height) 
-    : width_(width), height_(height), tileTexture_(nullptr), tilesPerRow_(16) {
-    tiles_.resize(width_ * height_);
+    : width_(width), height_(height), solidRevision_(0), journalBase_(0),
+      tileTexture_(nullptr), tilesPerRow_(16),
+      renderMode_(RenderMode::Chunked), chunkTextureLimit_(DEFAULT_CHUNK_TEXTURE_LIMIT),
+      chunksX_(0), chunksY_(0), chunkRenderer_(nullptr), chunksUnavailable_(false), frame_(0),
+      batchTiles_{0, 0, 0, 0}, batchCameraX_(0), batchCameraY_(0), batchDirty_(true) {
+    resize(width, height);
+}
+
+template<class F>
+bool Tilemap::scanSolidRow(int row, int firstX, int lastX, F&& f) const {
+    if (!pages_) {
+        const uint64_t* words = solidRow(row);
+        return scanBits([words](int i) { return words[i]; }, firstX, lastX, f);
+    }
+    
+    // A page row is one bitmap word wide, so word i is in page column i
+    static_assert(TilePages::PAGE_SIZE == 64, "paged solidity scans assume one word per page row");
+    const int pageY = row / TilePages::PAGE_SIZE;
+    const int pageRow = row % TilePages::PAGE_SIZE;
+    return scanBits([&](int i) {
+        const TilePages::Page* page = pages_->read(i, pageY);
+        return page ? page->solid[pageRow] : uint64_t(0);
+    }, firstX, lastX, f);
+}
+
+template<class F>
+void Tilemap::forEachRowSpan(int y, int startX, int endX, F&& f) const {
+    if (!pages_) {
+        f(typeRow(y) + startX, variantRow(y) + startX, startX, endX);
+        return;
+    }
+    
+    const int pageY = y / TilePages::PAGE_SIZE;
+    const int offset = (y % TilePages::PAGE_SIZE) * TilePages::PAGE_SIZE;
+    for (int pageX = startX / TilePages::PAGE_SIZE; pageX <= endX / TilePages::PAGE_SIZE; ++pageX) {
+        const TilePages::Page* page = pages_->read(pageX, pageY);
+        if (!page) continue;
+        
+        const int pageStart = pageX * TilePages::PAGE_SIZE;
+        const int firstX = std::max(startX, pageStart);
+        const int lastX = std::min(endX, pageStart + TilePages::PAGE_SIZE - 1);
+        const int column = offset + firstX - pageStart;
+        f(page->types.data() + column, page->variants.data() + column, firstX, lastX);
+    }
 }
 
 Tilemap::~Tilemap() {
+    releaseRenderCache();
     if (tileTexture_) {
         SDL_DestroyTexture(tileTexture_);
     }
 }
 
 void Tilemap::resize(int width, int height) {
-    width_ = width;
-    height_ = height;
-    tiles_.resize(width_ * height_);
+    pages_.reset();
+    width_ = std::max(0, width);
+    height_ = std::max(0, height);
+    solidStride_ = (width_ + 63) / 64;
+    
+    const size_t count = static_cast<size_t>(width_) * height_;
+    types_.assign(count, static_cast<uint8_t>(TileType::EMPTY));
+    variants_.assign(count, 0);
+    solid_.assign(static_cast<size_t>(solidStride_) * height_, 0);
+    resetChunks();
+    resetJournal();
 }
 
 void Tilemap::clear() {
-    for (auto& tile : tiles_) {
-        tile = Tile();
-    }
+    fill(TileType::EMPTY, false);
 }
 
 void Tilemap::fill(TileType type, bool solid) {
-    for (auto& tile : tiles_) {
-        tile = Tile(type, solid);
+    if (pages_) {
+        pages_->fill(static_cast<uint8_t>(type), solid);
+        invalidateRenderCache();
+        resetJournal();
+        return;
     }
-}
-
-Tile& Tilemap::getTile(int x, int y) {
-    static Tile emptyTile;
-    if (!isValidPosition(x, y)) {
-        return emptyTile;
+    
+    std::fill(types_.begin(), types_.end(), static_cast<uint8_t>(type));
+    std::fill(variants_.begin(), variants_.end(), 0);
+    
+    // Bits past the last column stay clear so word-wide counts are exact
+    const uint64_t tail = (width_ & 63) ? (uint64_t(1) << (width_ & 63)) - 1 : ~uint64_t(0);
+    for (int y = 0; y < height_; ++y) {
+        uint64_t* row = solid_.data() + static_cast<size_t>(y) * solidStride_;
+        for (int i = 0; i < solidStride_; ++i) {
+            row[i] = solid ? ~uint64_t(0) : 0;
+        }
+        if (solid && solidStride_ > 0) {
+            row[solidStride_ - 1] = tail;
+        }
     }
-    return tiles_[y * width_ + x];
+    invalidateRenderCache();
+    resetJournal();
 }
 
-const Tile& Tilemap::getTile(int x, int y) const {
-    static const Tile emptyTile;
+Tile Tilemap::getTile(int x, int y) const {
     if (!isValidPosition(x, y)) {
-        return emptyTile;
+        return Tile();
+    }
+    if (pages_) {
+        const TilePages::Page* page = pages_->read(x / TilePages::PAGE_SIZE, y / TilePages::PAGE_SIZE);
+        if (!page) {
+            return Tile();
+        }
+        const int index = (y % TilePages::PAGE_SIZE) * TilePages::PAGE_SIZE + x % TilePages::PAGE_SIZE;
+        return Tile(static_cast<TileType>(page->types[index]), (page->solid[y % TilePages::PAGE_SIZE] >> (x & 63)) & 1,
+                    page->variants[index]);
     }
-    return tiles_[y * width_ + x];
+    const size_t index = static_cast<size_t>(y) * width_ + x;
+    return Tile(static_cast<TileType>(types_[index]), testBit(solidRow(y), x), variants_[index]);
 }
 
 void Tilemap::setTile(int x, int y, TileType type, bool solid, uint8_t variant) {
     if (isValidPosition(x, y)) {
-        tiles_[y * width_ + x] = Tile(type, solid, variant);
+        uint64_t* solidWord;
+        if (pages_) {
+            const int pageX = x / TilePages::PAGE_SIZE;
+            const int pageY = y / TilePages::PAGE_SIZE;
+            
+            // An empty tile on an empty page changes nothing; leave the page unallocated
+            if (type == TileType::EMPTY && !solid && variant == 0 && !pages_->read(pageX, pageY)) {
+                return;
+            }
+            
+            TilePages::Page& page = pages_->write(pageX, pageY);
+            const int index = (y % TilePages::PAGE_SIZE) * TilePages::PAGE_SIZE + x % TilePages::PAGE_SIZE;
+            page.types[index] = static_cast<uint8_t>(type);
+            page.variants[index] = variant;
+            solidWord = &page.solid[y % TilePages::PAGE_SIZE];
+        } else {
+            const size_t index = static_cast<size_t>(y) * width_ + x;
+            types_[index] = static_cast<uint8_t>(type);
+            variants_[index] = variant;
+            solidWord = &solid_[static_cast<size_t>(y) * solidStride_ + (x >> 6)];
+        }
+        
+        uint64_t& word = *solidWord;
+        const uint64_t bit = uint64_t(1) << (x & 63);
+        if (((word & bit) != 0) != solid) {
+            word ^= bit;
+            journal_.push_back({++solidRevision_, x, y});
+            if (journal_.size() > JOURNAL_LIMIT) {
+                journalBase_ = journal_.front().revision;
+                journal_.pop_front();
+            }
+        }
+        markTileDirty(x, y);
     }
 }
 
+bool Tilemap::solidChangesSince(uint64_t revision, std::vector<SolidChange>& changes) const {
+    if (revision < journalBase_ || revision > solidRevision_) {
+        return false;
+    }
+    
+    // Entries are consecutive revisions starting at journalBase_ + 1
+    for (size_t i = revision - journalBase_; i < journal_.size(); ++i) {
+        changes.push_back(journal_[i]);
+    }
+    return true;
+}
+
+void Tilemap::resetJournal() {
+    journal_.clear();
+    journalBase_ = ++solidRevision_;
+}
+
 bool Tilemap::isValidPosition(int x, int y) const {
     return x >= 0 && x < width_ && y >= 0 && y < height_;
 }
 
 bool Tilemap::isSolid(int x, int y) const {
-    return getTile(x, y).solid;
+    if (!isValidPosition(x, y)) {
+        return false;
+    }
+    if (pages_) {
+        const TilePages::Page* page = pages_->read(x / TilePages::PAGE_SIZE, y / TilePages::PAGE_SIZE);
+        return page && ((page->solid[y % TilePages::PAGE_SIZE] >> (x & 63)) & 1);
+    }
+    return testBit(solidRow(y), x);
+}
+
+bool Tilemap::anySolid(int x, int y, int width, int height) const {
+    const int firstX = std::max(0, x);
+    const int firstY = std::max(0, y);
+    const int lastX = std::min(width_, x + width) - 1;
+    const int lastY = std::min(height_, y + height) - 1;
+    
+    for (int row = firstY; row <= lastY && firstX <= lastX; ++row) {
+        if (scanSolidRow(row, firstX, lastX, [](uint64_t bits, int) { return bits != 0; })) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int Tilemap::countSolid(int x, int y, int width, int height) const {
+    const int firstX = std::max(0, x);
+    const int firstY = std::max(0, y);
+    const int lastX = std::min(width_, x + width) - 1;
+    const int lastY = std::min(height_, y + height) - 1;
+    
+    int count = 0;
+    for (int row = firstY; row <= lastY && firstX <= lastX; ++row) {
+        scanSolidRow(row, firstX, lastX, [&](uint64_t bits, int) {
+            count += popcount64(bits);
+            return false;
+        });
+    }
+    return count;
+}
+
+bool Tilemap::firstContact(float x, float y, float width, float height, float dx, float dy,
+                           Contact& contact) const {
+    // Tiles the box can touch during the move
+    const int firstX = std::max(0, worldToTileX(std::min(x, x + dx)));
+    const int firstY = std::max(0, worldToTileY(std::min(y, y + dy)));
+    const int lastX = std::min(width_ - 1, worldToTileX(std::max(x, x + dx) + width));
+    const int lastY = std::min(height_ - 1, worldToTileY(std::max(y, y + dy) + height));
+    
+    const float invDx = dx != 0.0f ? 1.0f / dx : 0.0f;
+    const float invDy = dy != 0.0f ? 1.0f / dy : 0.0f;
+    bool found = false;
+    contact.time = 2.0f;
+    
+    for (int row = firstY; row <= lastY && firstX <= lastX; ++row) {
+        const float top = static_cast<float>(tileToWorldY(row));
+        const float bottom = top + TILE_SIZE;
+        
+        // Time interval during which the box overlaps this row vertically
+        float entryY, exitY;
+        if (dy != 0.0f) {
+            entryY = ((dy > 0 ? top : bottom) - (dy > 0 ? y + height : y)) * invDy;
+            exitY = ((dy > 0 ? bottom : top) - (dy > 0 ? y : y + height)) * invDy;
+        } else if (y + height > top && y < bottom) {
+            entryY = -INFINITY;
+            exitY = INFINITY;
+        } else {
+            continue;
+        }
+        
+        scanSolidRow(row, firstX, lastX, [&](uint64_t bits, int firstTile) {
+            for (; bits; bits &= bits - 1) {
+                const int column = firstTile + countTrailingZeros64(bits);
+                const float left = static_cast<float>(tileToWorldX(column));
+                const float right = left + TILE_SIZE;
+                
+                float entryX, exitX;
+                if (dx != 0.0f) {
+                    entryX = ((dx > 0 ? left : right) - (dx > 0 ? x + width : x)) * invDx;
+                    exitX = ((dx > 0 ? right : left) - (dx > 0 ? x : x + width)) * invDx;
+                } else if (x + width > left && x < right) {
+                    entryX = -INFINITY;
+                    exitX = INFINITY;
+                } else {
+                    continue;
+                }
+                
+                // Contact starts when both axes overlap; overlaps already in progress are ignored
+                const float entry = std::max(entryX, entryY);
+                const float exit = std::min(exitX, exitY);
+                if (entry >= exit || entry < 0.0f || entry > 1.0f || entry >= contact.time) {
+                    continue;
+                }
+                
+                found = true;
+                contact.time = entry;
+                if (entryX >= entryY) {
+                    contact.normalX = dx > 0 ? -1 : 1;
+                    contact.normalY = 0;
+                    contact.position = dx > 0 ? left - width : right;
+                } else {
+                    contact.normalX = 0;
+                    contact.normalY = dy > 0 ? -1 : 1;
+                    contact.position = dy > 0 ? top - height : bottom;
+                }
+            }
+            return false;
+        });
+    }
+    return found;
+}
+
+SweepResult Tilemap::sweepBox(float x, float y, float width, float height, float dx, float dy) const {
+    SweepResult result;
+    result.x = x;
+    result.y = y;
+    
+    // Each contact stops one axis, so two passes resolve any move
+    for (int pass = 0; pass < 2 && (dx != 0.0f || dy != 0.0f); ++pass) {
+        Contact contact;
+        if (!firstContact(result.x, result.y, width, height, dx, dy, contact)) {
+            result.x += dx;
+            result.y += dy;
+            break;
+        }
+        
+        if (pass == 0) {
+            result.hit = true;
+            result.time = contact.time;
+            result.normalX = contact.normalX;
+            result.normalY = contact.normalY;
+        }
+        
+        // Snap to the contact surface and slide along it with the rest of the move
+        if (contact.normalX != 0) {
+            result.x = contact.position;
+            result.y += dy * contact.time;
+            result.blockedX = true;
+            dx = 0.0f;
+            dy *= 1.0f - contact.time;
+        } else {
+            result.y = contact.position;
+            result.x += dx * contact.time;
+            result.blockedY = true;
+            dy = 0.0f;
+            dx *= 1.0f - contact.time;
+        }
+    }
+    
+    return result;
+}
+
+void Tilemap::sweepBoxes(size_t count, float* x, float* y, const float* width, const float* height,
+                         float* dx, float* dy, uint8_t* blocked) const {
+    for (size_t i = 0; i < count; ++i) {
+        SweepResult result = sweepBox(x[i], y[i], width[i], height[i], dx[i], dy[i]);
+        x[i] = result.x;
+        y[i] = result.y;
+        if (result.blockedX) dx[i] = 0.0f;
+        if (result.blockedY) dy[i] = 0.0f;
+        if (blocked) {
+            blocked[i] = (result.blockedX ? BLOCKED_X : 0) | (result.blockedY ? BLOCKED_Y : 0);
+        }
+    }
+}
+
+void Tilemap::buildSolid(const std::array<bool, 256>& solidTypes) {
+    resetJournal();
+    fillSolidBitmap(types_.data(), width_, height_, solidStride_, solidTypes, solid_.data());
 }
 
 bool Tilemap::loadTileTexture(SDL_Renderer* renderer, const char* filename, int tilesPerRow) {
@@ -81,6 +430,7 @@ bool Tilemap::loadTileTexture(SDL_Renderer* renderer, const char* filename, int
     }
     
     tilesPerRow_ = tilesPerRow;
+    invalidateRenderCache();
     return true;
 }
 
@@ -180,29 +530,292 @@ void Tilemap::createDefaultTexture(SDL_Renderer* renderer) {
     if (!tileTexture_) {
         std::cout << "Error: Could not create default tile texture: " << SDL_GetError() << std::endl;
     }
+    invalidateRenderCache();
 }
 
 void Tilemap::render(SDL_Renderer* renderer, int cameraX, int cameraY, 
                     int screenWidth, int screenHeight) const {
+    PROFILE_SCOPE("tilemap.render");
     if (!tileTexture_) return;
     
+    if (renderMode_ == RenderMode::Chunked && (!chunksUnavailable_ || renderer != chunkRenderer_)) {
+        renderChunks(renderer, cameraX, cameraY, screenWidth, screenHeight);
+        return;
+    }
+    
     // Calculate which tiles are visible
     int startTileX = std::max(0, cameraX / TILE_SIZE);
     int startTileY = std::max(0, cameraY / TILE_SIZE);
     int endTileX = std::min(width_ - 1, (cameraX + screenWidth) / TILE_SIZE + 1);
     int endTileY = std::min(height_ - 1, (cameraY + screenHeight) / TILE_SIZE + 1);
     
-    // Render visible tiles
-    for (int y = startTileY; y <= endTileY; ++y) {
-        for (int x = startTileX; x <= endTileX; ++x) {
-            const Tile& tile = getTile(x, y);
-            if (tile.type != TileType::EMPTY) {
-                int screenX = x * TILE_SIZE - cameraX;
-                int screenY = y * TILE_SIZE - cameraY;
-                renderTile(renderer, tile.type, tile.variant, screenX, screenY);
+    if (renderMode_ == RenderMode::Batched) {
+        renderBatched(renderer, startTileX, startTileY, endTileX, endTileY, cameraX, cameraY);
+        return;
+    }
+    
+    renderTiles(renderer, startTileX, startTileY, endTileX, endTileY, cameraX, cameraY);
+}
+
+void Tilemap::renderBatched(SDL_Renderer* renderer, int startX, int startY, int endX, int endY,
+                            int cameraX, int cameraY) const {
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    SDL_Rect tiles = {startX, startY, endX - startX + 1, endY - startY + 1};
+    
+    if (batchDirty_ || tiles.x != batchTiles_.x || tiles.y != batchTiles_.y ||
+        tiles.w != batchTiles_.w || tiles.h != batchTiles_.h) {
+        int textureWidth = 0;
+        int textureHeight = 0;
+        SDL_QueryTexture(tileTexture_, nullptr, nullptr, &textureWidth, &textureHeight);
+        const float u = 1.0f / std::max(1, textureWidth);
+        const float v = 1.0f / std::max(1, textureHeight);
+        const SDL_Color white = {255, 255, 255, 255};
+        
+        // Room for every tile in range; trimmed to the non-empty ones below
+        batchVertices_.resize(static_cast<size_t>(tiles.w) * tiles.h * 4);
+        SDL_Vertex* out = batchVertices_.data();
+        for (int y = startY; y <= endY; ++y) {
+            forEachRowSpan(y, startX, endX, [&](const uint8_t* types, const uint8_t* variants, int firstX, int lastX) {
+                for (int x = firstX; x <= lastX; ++x) {
+                    const int i = x - firstX;
+                    if (types[i] == static_cast<uint8_t>(TileType::EMPTY)) continue;
+                    
+                    int tileIndex = types[i] + variants[i];
+                    float srcX = static_cast<float>((tileIndex % tilesPerRow_) * TILE_SIZE);
+                    float srcY = static_cast<float>((tileIndex / tilesPerRow_) * TILE_SIZE);
+                    float left = static_cast<float>(x * TILE_SIZE - cameraX);
+                    float top = static_cast<float>(y * TILE_SIZE - cameraY);
+                    
+                    *out++ = {{left, top}, white, {srcX * u, srcY * v}};
+                    *out++ = {{left + TILE_SIZE, top}, white, {(srcX + TILE_SIZE) * u, srcY * v}};
+                    *out++ = {{left + TILE_SIZE, top + TILE_SIZE}, white, {(srcX + TILE_SIZE) * u, (srcY + TILE_SIZE) * v}};
+                    *out++ = {{left, top + TILE_SIZE}, white, {srcX * u, (srcY + TILE_SIZE) * v}};
+                }
+            });
+        }
+        batchVertices_.resize(out - batchVertices_.data());
+        
+        // The index pattern only depends on the quad count, so it only ever grows
+        const size_t quads = batchVertices_.size() / 4;
+        for (size_t quad = batchIndices_.size() / 6; quad < quads; ++quad) {
+            int first = static_cast<int>(quad * 4);
+            batchIndices_.insert(batchIndices_.end(), {first, first + 1, first + 2, first, first + 2, first + 3});
+        }
+        
+        batchTiles_ = tiles;
+        batchCameraX_ = cameraX;
+        batchCameraY_ = cameraY;
+        batchDirty_ = false;
+    } else if (cameraX != batchCameraX_ || cameraY != batchCameraY_) {
+        // Same tiles, camera moved within a tile: shift the quads
+        const float dx = static_cast<float>(batchCameraX_ - cameraX);
+        const float dy = static_cast<float>(batchCameraY_ - cameraY);
+        for (SDL_Vertex& vertex : batchVertices_) {
+            vertex.position.x += dx;
+            vertex.position.y += dy;
+        }
+        batchCameraX_ = cameraX;
+        batchCameraY_ = cameraY;
+    }
+    
+    if (!batchVertices_.empty()) {
+        SDL_RenderGeometry(renderer, tileTexture_, batchVertices_.data(), static_cast<int>(batchVertices_.size()),
+                           batchIndices_.data(), static_cast<int>(batchVertices_.size() / 4 * 6));
+        PROFILE_DRAW_CALLS(1);
+    }
+#else
+    // SDL_RenderGeometry needs SDL 2.0.18
+    renderTiles(renderer, startX, startY, endX, endY, cameraX, cameraY);
+#endif
+}
+
+void Tilemap::renderTiles(SDL_Renderer* renderer, int startX, int startY, int endX, int endY,
+                          int offsetX, int offsetY) const {
+    for (int y = startY; y <= endY; ++y) {
+        forEachRowSpan(y, startX, endX, [&](const uint8_t* types, const uint8_t* variants, int firstX, int lastX) {
+            for (int x = firstX; x <= lastX; ++x) {
+                const int i = x - firstX;
+                if (types[i] != static_cast<uint8_t>(TileType::EMPTY)) {
+                    renderTile(renderer, static_cast<TileType>(types[i]), variants[i],
+                               x * TILE_SIZE - offsetX, y * TILE_SIZE - offsetY);
+                }
             }
+        });
+    }
+}
+
+void Tilemap::renderChunks(SDL_Renderer* renderer, int cameraX, int cameraY,
+                           int screenWidth, int screenHeight) const {
+    // Chunk textures belong to one renderer
+    if (chunkRenderer_ != renderer) {
+        releaseRenderCache();
+        chunkRenderer_ = renderer;
+        chunksUnavailable_ = !SDL_RenderTargetSupported(renderer);
+        if (chunksUnavailable_) {
+            std::cout << "Warning: Render targets not supported, using immediate tile rendering" << std::endl;
+            render(renderer, cameraX, cameraY, screenWidth, screenHeight);
+            return;
+        }
+    }
+    
+    ++frame_;
+    
+    // Calculate which chunks are visible
+    int startChunkX = std::max(0, cameraX / CHUNK_PIXELS);
+    int startChunkY = std::max(0, cameraY / CHUNK_PIXELS);
+    int endChunkX = std::min(chunksX_ - 1, (cameraX + screenWidth - 1) / CHUNK_PIXELS);
+    int endChunkY = std::min(chunksY_ - 1, (cameraY + screenHeight - 1) / CHUNK_PIXELS);
+    
+    for (int cy = startChunkY; cy <= endChunkY; ++cy) {
+        for (int cx = startChunkX; cx <= endChunkX; ++cx) {
+            int chunkX = cx * CHUNK_PIXELS;
+            int chunkY = cy * CHUNK_PIXELS;
+            
+            if (SDL_Texture* texture = prepareChunk(renderer, cx, cy)) {
+                SDL_Rect dstRect = {chunkX - cameraX, chunkY - cameraY, CHUNK_PIXELS, CHUNK_PIXELS};
+                SDL_RenderCopy(renderer, texture, nullptr, &dstRect);
+                PROFILE_DRAW_CALLS(1);
+            } else {
+                // No texture available (limit reached or creation failed): draw the tiles directly
+                int startX = cx * CHUNK_TILES;
+                int startY = cy * CHUNK_TILES;
+                renderTiles(renderer, startX, startY, std::min(width_, startX + CHUNK_TILES) - 1,
+                            std::min(height_, startY + CHUNK_TILES) - 1, cameraX, cameraY);
+            }
+            
+            if (chunksUnavailable_) {
+                // Render targets failed mid-frame; finish the frame the old way
+                render(renderer, cameraX, cameraY, screenWidth, screenHeight);
+                return;
+            }
+        }
+    }
+}
+
+SDL_Texture* Tilemap::prepareChunk(SDL_Renderer* renderer, int chunkX, int chunkY) const {
+    const uint64_t key = chunkKey(chunkX, chunkY);
+    auto found = chunks_.find(key);
+    
+    if (found == chunks_.end()) {
+        Chunk chunk;
+        
+        // Reuse the least recently drawn texture once the limit is reached
+        if (chunks_.size() >= chunkTextureLimit_) {
+            auto victim = chunks_.end();
+            uint32_t oldest = frame_;
+            for (auto it = chunks_.begin(); it != chunks_.end(); ++it) {
+                if (it->second.lastUsed < oldest) {
+                    oldest = it->second.lastUsed;
+                    victim = it;
+                }
+            }
+            
+            // Everything resident is on screen this frame
+            if (victim == chunks_.end()) {
+                return nullptr;
+            }
+            
+            chunk.texture = victim->second.texture;
+            chunks_.erase(victim);
+        } else {
+            chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA8888, SDL_TEXTUREACCESS_TARGET,
+                                              CHUNK_PIXELS, CHUNK_PIXELS);
+            if (!chunk.texture) {
+                std::cout << "Warning: Could not create chunk texture, using immediate tile rendering: "
+                          << SDL_GetError() << std::endl;
+                chunksUnavailable_ = true;
+                return nullptr;
+            }
+            SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
         }
+        found = chunks_.emplace(key, chunk).first;
     }
+    
+    Chunk& chunk = found->second;
+    if (chunk.dirty) {
+        rebuildChunk(renderer, chunkX, chunkY, chunk);
+    }
+    
+    chunk.lastUsed = frame_;
+    return chunksUnavailable_ ? nullptr : chunk.texture;
+}
+
+void Tilemap::rebuildChunk(SDL_Renderer* renderer, int chunkX, int chunkY, Chunk& chunk) const {
+    int startX = chunkX * CHUNK_TILES;
+    int startY = chunkY * CHUNK_TILES;
+    
+    SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+    if (SDL_SetRenderTarget(renderer, chunk.texture) != 0) {
+        std::cout << "Warning: Could not render to chunk texture, using immediate tile rendering: "
+                  << SDL_GetError() << std::endl;
+        chunksUnavailable_ = true;
+        return;
+    }
+    
+    // Empty tiles stay transparent so the background shows through, as in immediate mode
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer, &r, &g, &b, &a);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, r, g, b, a);
+    PROFILE_DRAW_CALLS(1);
+    
+    renderTiles(renderer, startX, startY, std::min(width_, startX + CHUNK_TILES) - 1,
+                std::min(height_, startY + CHUNK_TILES) - 1, startX * TILE_SIZE, startY * TILE_SIZE);
+    
+    SDL_SetRenderTarget(renderer, previousTarget);
+    chunk.dirty = false;
+}
+
+void Tilemap::setChunkTextureLimit(size_t limit) {
+    chunkTextureLimit_ = std::max<size_t>(1, limit);
+    
+    // Drop the least recently used textures above the new limit
+    while (chunks_.size() > chunkTextureLimit_) {
+        auto oldest = std::min_element(chunks_.begin(), chunks_.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUsed < b.second.lastUsed;
+        });
+        SDL_DestroyTexture(oldest->second.texture);
+        chunks_.erase(oldest);
+    }
+}
+
+void Tilemap::invalidateRenderCache() const {
+    for (auto& entry : chunks_) {
+        entry.second.dirty = true;
+    }
+    batchDirty_ = true;
+}
+
+void Tilemap::releaseRenderCache() const {
+    for (auto& entry : chunks_) {
+        SDL_DestroyTexture(entry.second.texture);
+    }
+    chunks_.clear();
+    invalidateRenderCache();
+}
+
+void Tilemap::resetChunks() {
+    int chunksX = (width_ + CHUNK_TILES - 1) / CHUNK_TILES;
+    int chunksY = (height_ + CHUNK_TILES - 1) / CHUNK_TILES;
+    
+    // Same chunk grid: keep the textures and redraw them
+    if (chunksX == chunksX_ && chunksY == chunksY_) {
+        invalidateRenderCache();
+        return;
+    }
+    
+    releaseRenderCache();
+    chunksX_ = chunksX;
+    chunksY_ = chunksY;
+}
+
+void Tilemap::markTileDirty(int x, int y) {
+    auto found = chunks_.find(chunkKey(x / CHUNK_TILES, y / CHUNK_TILES));
+    if (found != chunks_.end()) {
+        found->second.dirty = true;
+    }
+    batchDirty_ = true;
 }
 
 void Tilemap::renderTile(SDL_Renderer* renderer, TileType type, uint8_t variant, 
@@ -217,6 +830,7 @@ void Tilemap::renderTile(SDL_Renderer* renderer, TileType type, uint8_t variant,
     SDL_Rect dstRect = {screenX, screenY, TILE_SIZE, TILE_SIZE};
     
     SDL_RenderCopy(renderer, tileTexture_, &srcRect, &dstRect);
+    PROFILE_DRAW_CALLS(1);
 }
 
 void Tilemap::generateTestMap() {
@@ -313,75 +927,229 @@ void Tilemap::createCorridor(int x1, int y1, int x2, int y2, bool horizontal) {
     }
 }
 
+bool Tilemap::loadMap(const std::string& filename) {
+    PROFILE_SCOPE("map.load");
+    if (MapFormat::hasExtension(filename, MapFormat::BINARY_EXTENSION)) {
+        return loadFromBinary(filename);
+    }
+    return loadFromCSV(filename);
+}
+
 bool Tilemap::loadFromCSV(const std::string& filename) {
-    std::string fullPath = "assets/maps/" + filename;
-    std::ifstream file(fullPath);
+    TileBuffer buffer;
+    if (!buffer.loadCSV("assets/maps/" + filename)) {
+        return false;
+    }
     
-    if (!file.is_open()) {
-        std::cout << "Error: Could not open map file: " << fullPath << std::endl;
+    swapBuffer(buffer);
+    std::cout << "Loaded map: " << filename << " (" << width_ << "x" << height_ << ")" << std::endl;
+    return true;
+}
+
+bool Tilemap::loadFromBinary(const std::string& filename) {
+    TileBuffer buffer;
+    if (!buffer.loadBinary("assets/maps/" + filename)) {
         return false;
     }
     
-    std::string line;
+    swapBuffer(buffer);
+    std::cout << "Loaded map: " << filename << " (" << width_ << "x" << height_ << ")" << std::endl;
+    return true;
+}
+
+void Tilemap::loadMapData(const MapData& map) {
+    resize(map.width, map.height);
     
-    // Read dimensions from first line
-    if (!std::getline(file, line)) {
-        std::cout << "Error: Empty map file: " << fullPath << std::endl;
+    types_ = map.types;
+    if (!map.variants.empty()) {
+        variants_ = map.variants;
+    }
+    buildSolid(map.solidTypes);
+}
+
+bool Tilemap::loadPaged(const std::string& filename, size_t budgetBytes) {
+    std::string fullPath = "assets/maps/" + filename;
+    if (!MapFormat::hasExtension(filename, MapFormat::BINARY_EXTENSION)) {
+        std::cout << "Error: Paged maps must be binary (" << MapFormat::BINARY_EXTENSION << "): "
+                  << filename << std::endl;
         return false;
     }
     
-    std::stringstream ss(line);
-    std::string cell;
+    auto pages = std::make_unique<TilePages>();
+    pages->setBudget(budgetBytes);
+    if (!pages->open(fullPath)) {
+        return false;
+    }
+    usePages(std::move(pages));
     
-    if (!std::getline(ss, cell, ',')) {
-        std::cout << "Error: Invalid dimensions in map file: " << fullPath << std::endl;
+    std::cout << "Loaded paged map: " << filename << " (" << width_ << "x" << height_ << ")" << std::endl;
+    return true;
+}
+
+void Tilemap::resizePaged(int width, int height) {
+    std::array<bool, 256> solidTypes{};
+    for (int i = 0; i < 256; ++i) {
+        solidTypes[i] = isSolidTileType(static_cast<TileType>(i));
+    }
+    
+    auto pages = std::make_unique<TilePages>();
+    pages->reset(width, height, solidTypes);
+    usePages(std::move(pages));
+}
+
+void Tilemap::usePages(std::unique_ptr<TilePages> pages) {
+    pages_ = std::move(pages);
+    width_ = pages_->getWidth();
+    height_ = pages_->getHeight();
+    solidStride_ = 0;
+    std::vector<uint8_t>().swap(types_);
+    std::vector<uint8_t>().swap(variants_);
+    std::vector<uint64_t>().swap(solid_);
+    resetChunks();
+    resetJournal();
+}
+
+void Tilemap::swapBuffer(TileBuffer& buffer) {
+    // A paged map has no planes to hand over: buffer gets an empty map
+    if (pages_) {
+        pages_.reset();
+        width_ = 0;
+        height_ = 0;
+    }
+    std::swap(width_, buffer.width);
+    std::swap(height_, buffer.height);
+    std::swap(solidStride_, buffer.solidStride);
+    types_.swap(buffer.types);
+    variants_.swap(buffer.variants);
+    solid_.swap(buffer.solid);
+    resetChunks();
+    resetJournal();
+}
+
+bool TileBuffer::load(const std::string& filename) {
+    std::string fullPath = "assets/maps/" + filename;
+    if (MapFormat::hasExtension(filename, MapFormat::BINARY_EXTENSION)) {
+        return loadBinary(fullPath);
+    }
+    return loadCSV(fullPath);
+}
+
+bool TileBuffer::loadBinary(const std::string& path) {
+    MappedFile file;
+    if (!file.open(path)) {
+        std::cout << "Error: Could not open map file: " << path << std::endl;
         return false;
     }
-    int newWidth = std::stoi(cell);
     
-    if (!std::getline(ss, cell, ',')) {
-        std::cout << "Error: Invalid dimensions in map file: " << fullPath << std::endl;
+    MapFormat::View view;
+    if (!MapFormat::viewBinary(file, path, view)) {
         return false;
     }
-    int newHeight = std::stoi(cell);
     
-    // Resize map to match CSV dimensions
-    resize(newWidth, newHeight);
-    clear();
+    // The file planes match the in-memory planes
+    setSize(view.width, view.height);
+    std::copy(view.types, view.types + types.size(), types.begin());
+    if (view.variants) {
+        std::copy(view.variants, view.variants + variants.size(), variants.begin());
+    } else {
+        std::fill(variants.begin(), variants.end(), 0);
+    }
     
-    // Read tile data
-    int row = 0;
-    while (std::getline(file, line) && row < height_) {
-        std::stringstream rowSS(line);
-        int col = 0;
-        
-        while (std::getline(rowSS, cell, ',') && col < width_) {
-            int tileId = std::stoi(cell);
-            TileType type = static_cast<TileType>(tileId);
-            bool solid = (type >= TileType::WALL_BRICK && type <= TileType::WALL_INNER_BOTTOM_RIGHT);
-            setTile(col, row, type, solid);
-            col++;
-        }
-        row++;
+    std::array<bool, 256> solidTypes;
+    view.solidTypes(solidTypes);
+    buildSolid(solidTypes);
+    return true;
+}
+
+bool TileBuffer::loadCSV(const std::string& path) {
+    MapData map;
+    if (!MapFormat::readCSV(path, map)) {
+        return false;
     }
     
-    file.close();
-    std::cout << "Loaded map: " << filename << " (" << width_ << "x" << height_ << ")" << std::endl;
+    setSize(map.width, map.height);
+    types.swap(map.types);
+    if (map.variants.empty()) {
+        std::fill(variants.begin(), variants.end(), 0);
+    } else {
+        variants.swap(map.variants);
+    }
+    buildSolid(map.solidTypes);
     return true;
 }
 
-std::vector<std::string> Tilemap::getAvailableMaps() const {
+void TileBuffer::setSize(int newWidth, int newHeight) {
+    width = std::max(0, newWidth);
+    height = std::max(0, newHeight);
+    solidStride = (width + 63) / 64;
+    
+    const size_t count = static_cast<size_t>(width) * height;
+    types.resize(count);
+    variants.resize(count);
+    solid.resize(static_cast<size_t>(solidStride) * height);
+}
+
+size_t TileBuffer::bytesFor(int width, int height) {
+    const size_t count = static_cast<size_t>(std::max(0, width)) * std::max(0, height);
+    const size_t solidWords = static_cast<size_t>((std::max(0, width) + 63) / 64) * std::max(0, height);
+    return count * 2 + solidWords * sizeof(uint64_t);
+}
+
+void TileBuffer::buildSolid(const std::array<bool, 256>& solidTypes) {
+    fillSolidBitmap(types.data(), width, height, solidStride, solidTypes, solid.data());
+}
+
+void Tilemap::loadFromMaze(const MazeGrid& maze) {
+    resize(maze.width, maze.height);
+    
+    for (int y = 0; y < height_; ++y) {
+        const uint8_t* src = maze.row(y);
+        uint8_t* dst = types_.data() + static_cast<size_t>(y) * width_;
+        for (int x = 0; x < width_; ++x) {
+            dst[x] = static_cast<uint8_t>(MazeGenerator::convertTileValue(src[x]));
+        }
+    }
+    
+    std::array<bool, 256> solidTypes;
+    for (int i = 0; i < 256; ++i) {
+        solidTypes[i] = isSolidTileType(static_cast<TileType>(i));
+    }
+    buildSolid(solidTypes);
+}
+
+std::vector<std::string> Tilemap::getAvailableMaps(const std::string& filter, bool sortBySize) const {
     std::vector<std::string> maps;
     std::string mapsDir = "assets/maps";
     
-    try {
-        for (const auto& entry : std::filesystem::directory_iterator(mapsDir)) {
-            if (entry.is_regular_file() && entry.path().extension() == ".csv") {
-                maps.push_back(entry.path().filename().string());
+    MapManifest manifest;
+    if (manifest.load(mapsDir)) {
+        std::vector<const MapInfo*> matches;
+        for (const MapInfo& info : manifest.maps) {
+            if (filter.empty() || info.name.find(filter) != std::string::npos ||
+                info.preset.find(filter) != std::string::npos) {
+                matches.push_back(&info);
             }
         }
-    } catch (const std::exception& e) {
-        std::cout << "Warning: Could not read maps directory: " << e.what() << std::endl;
+        if (sortBySize) {
+            std::stable_sort(matches.begin(), matches.end(), [](const MapInfo* a, const MapInfo* b) {
+                return int64_t(a->width) * a->height < int64_t(b->width) * b->height;
+            });
+        }
+        for (const MapInfo* info : matches) {
+            maps.push_back(info->name);
+        }
+        return maps;
+    }
+    
+    // No current manifest: names only
+    if (sortBySize) {
+        std::cout << "Warning: Sorting maps by size needs " << mapsDir << "/" << MapManifest::FILENAME
+                  << " (run generate_maps index); sorting by name" << std::endl;
+    }
+    for (const std::string& name : MapManifest::scanDirectory(mapsDir)) {
+        if (filter.empty() || name.find(filter) != std::string::npos) {
+            maps.push_back(name);
+        }
     }
     
     return maps;
@@ -3,41 +3,22 @@
 #include <SDL2/SDL.h>
 #include <vector>
 #include <memory>
+#include <deque>
+#include <array>
+#include <cmath>
 #include <string>
 #include <fstream>
+#include <unordered_map>
+#include "maze_grid.h"
+#include "tile_types.h"
+#include "map_format.h"
+#include "tile_pages.h"
 
 // Constants
 const int TILE_SIZE = 16;
+const int CHUNK_TILES = 32;  // Chunk edge in tiles for cached rendering
 
-// Tile types
-enum class TileType : uint8_t {
-    EMPTY = 0,
-    FLOOR = 1,
-    
-    // Wall types matching original Crossroads style
-    WALL_BRICK = 2,          // Orange brick wall (main wall type)
-    WALL_TOP = 3,            // Top edge of wall
-    WALL_BOTTOM = 4,         // Bottom edge of wall  
-    WALL_LEFT = 5,           // Left edge of wall
-    WALL_RIGHT = 6,          // Right edge of wall
-    WALL_TOP_LEFT = 7,       // Top-left corner
-    WALL_TOP_RIGHT = 8,      // Top-right corner
-    WALL_BOTTOM_LEFT = 9,    // Bottom-left corner
-    WALL_BOTTOM_RIGHT = 10,  // Bottom-right corner
-    WALL_INNER_TOP_LEFT = 11,     // Inner corner top-left
-    WALL_INNER_TOP_RIGHT = 12,    // Inner corner top-right
-    WALL_INNER_BOTTOM_LEFT = 13,  // Inner corner bottom-left
-    WALL_INNER_BOTTOM_RIGHT = 14, // Inner corner bottom-right
-    
-    // Additional tile types
-    WATER = 15,
-    GRASS = 16,
-    
-    // Add more tile types as needed
-    MAX_TILES = 255
-};
-
-// Individual tile data
+// Individual tile data (a value snapshot; the map stores tiles as separate planes)
 struct Tile {
     TileType type = TileType::EMPTY;
     uint8_t variant = 0;  // For tile variations (different sprites for same type)
@@ -48,27 +29,119 @@ struct Tile {
         : type(t), variant(var), solid(isSolid) {}
 };
 
+// Result of Tilemap::sweepBox, in world pixels
+struct SweepResult {
+    bool hit = false;       // Something was in the way
+    float time = 1.0f;      // Fraction of the move made before the first contact (1 if no hit)
+    int normalX = 0;        // Normal of the first contact surface (-1, 0 or 1 per axis)
+    int normalY = 0;
+    float x = 0.0f;         // Final top-left position after sliding along contact surfaces
+    float y = 0.0f;
+    bool blockedX = false;  // Horizontal motion was stopped
+    bool blockedY = false;  // Vertical motion was stopped
+};
+
+// A tile whose solidity changed, stamped with the solid revision it produced
+struct SolidChange {
+    uint64_t revision;
+    int x;
+    int y;
+};
+
+// Tile planes in Tilemap's in-memory layout, built away from the live map (on a
+// loader thread, say) and exchanged with Tilemap::swapBuffer(). Uses no SDL.
+struct TileBuffer {
+    int width = 0;
+    int height = 0;
+    int solidStride = 0;            // Words per solid bitmap row
+    std::vector<uint8_t> types;
+    std::vector<uint8_t> variants;
+    std::vector<uint64_t> solid;
+    
+    // Read a map from assets/maps in any format Tilemap::loadMap() takes; errors go to stdout
+    bool load(const std::string& filename);
+    
+    // Read a binary (.crmap) or CSV map from an explicit path; errors go to stdout
+    bool loadBinary(const std::string& path);
+    bool loadCSV(const std::string& path);
+    
+    // Size the planes (reusing their capacity); contents are unspecified until filled
+    void setSize(int width, int height);
+    
+    // Bytes of the planes setSize() allocates for a fresh buffer
+    static size_t bytesFor(int width, int height);
+    
+    // Rebuild the solid bitmap from the type plane
+    void buildSolid(const std::array<bool, 256>& solidTypes);
+};
+
+// How render() draws the map
+enum class RenderMode {
+    Immediate,  // One copy per visible tile every frame
+    Chunked,    // Cached CHUNK_TILES x CHUNK_TILES render-target textures, rebuilt when dirty
+    Batched     // All visible tiles as one SDL_RenderGeometry call (SDL 2.0.18+, else Immediate)
+};
+
 // Tilemap class
 class Tilemap {
 private:
+    // Pre-rendered block of tiles, in chunks_ while it holds a texture
+    struct Chunk {
+        SDL_Texture* texture = nullptr;
+        bool dirty = true;
+        uint32_t lastUsed = 0;  // Frame the chunk was last drawn, for eviction
+    };
+    
     int width_;
     int height_;
-    std::vector<Tile> tiles_;
+    
+    // Structure-of-arrays tile storage, row-major
+    std::vector<uint8_t> types_;     // TileType per tile
+    std::vector<uint8_t> variants_;  // Sprite variant per tile
+    std::vector<uint64_t> solid_;    // Solid bitmap, 64 tiles per word; each row starts on a new word
+    int solidStride_;                // Words per bitmap row
+    std::unique_ptr<TilePages> pages_;  // Paged mode storage instead of the planes above; null when dense
+    
+    // Solidity change journal for derived data (flow fields, navigation graphs)
+    uint64_t solidRevision_;         // Bumped by every solidity change
+    uint64_t journalBase_;           // Changes after this revision are in journal_
+    std::deque<SolidChange> journal_;
     SDL_Texture* tileTexture_;
     int tilesPerRow_;  // Number of tiles per row in the texture
     
+    // Chunk cache (render() is const; the cache is not part of the map state)
+    RenderMode renderMode_;
+    size_t chunkTextureLimit_;
+    int chunksX_;
+    int chunksY_;
+    mutable std::unordered_map<uint64_t, Chunk> chunks_;  // Chunks holding a texture, by chunkKey()
+    mutable SDL_Renderer* chunkRenderer_;                 // Renderer that owns the chunk textures
+    mutable bool chunksUnavailable_;                      // Render targets failed; stay immediate
+    mutable uint32_t frame_;
+    
+    // Geometry batch for RenderMode::Batched: 4 vertices per visible non-empty tile.
+    // Rebuilt when the visible tile range or the tiles change; sub-tile camera moves
+    // only translate the vertices.
+#if SDL_VERSION_ATLEAST(2, 0, 18)
+    mutable std::vector<SDL_Vertex> batchVertices_;
+    mutable std::vector<int> batchIndices_;
+#endif
+    mutable SDL_Rect batchTiles_;  // Visible tile range the batch was built for
+    mutable int batchCameraX_;
+    mutable int batchCameraY_;
+    mutable bool batchDirty_;
+    
 public:
     Tilemap(int width, int height);
     ~Tilemap();
     
     // Map management
-    void resize(int width, int height);
+    void resize(int width, int height);  // Also clears the map
     void clear();
     void fill(TileType type, bool solid = false);
     
-    // Tile access
-    Tile& getTile(int x, int y);
-    const Tile& getTile(int x, int y) const;
+    // Tile access (out-of-bounds reads give an empty, non-solid tile)
+    Tile getTile(int x, int y) const;
     void setTile(int x, int y, TileType type, bool solid = false, uint8_t variant = 0);
     
     // Utility functions
@@ -77,6 +150,47 @@ public:
     int getWidth() const { return width_; }
     int getHeight() const { return height_; }
     
+    // Unchecked row access for hot loops (0 <= y < height); dense maps only
+    const uint8_t* typeRow(int y) const { return types_.data() + static_cast<size_t>(y) * width_; }
+    const uint8_t* variantRow(int y) const { return variants_.data() + static_cast<size_t>(y) * width_; }
+    const uint64_t* solidRow(int y) const { return solid_.data() + static_cast<size_t>(y) * solidStride_; }
+    int getSolidStride() const { return solidStride_; }
+    static bool testBit(const uint64_t* row, int x) { return (row[x >> 6] >> (x & 63)) & 1; }
+    
+    // Bulk solidity queries over a tile rectangle, clipped to the map
+    bool anySolid(int x, int y, int width, int height) const;
+    int countSolid(int x, int y, int width, int height) const;
+    
+    // Solidity change journal. Consumers remember getSolidRevision() and later ask for
+    // the tiles changed since. solidChangesSince() returns false when that history is
+    // gone (map loaded, filled or resized, or more than JOURNAL_LIMIT changes ago);
+    // the consumer must then rebuild from scratch.
+    static constexpr size_t JOURNAL_LIMIT = 4096;
+    uint64_t getSolidRevision() const { return solidRevision_; }
+    bool solidChangesSince(uint64_t revision, std::vector<SolidChange>& changes) const;
+    
+    // Swept box collision in world pixels. The box (top-left x, y) moves by (dx, dy)
+    // against solid tiles; tiles outside the map are open. The move stops at the first
+    // contact and slides along it with the remaining motion. Boxes that already overlap
+    // a tile are not pushed out, and can move out of it.
+    SweepResult sweepBox(float x, float y, float width, float height, float dx, float dy) const;
+    
+    // sweepBox for count movers stored as parallel arrays. Positions are advanced in
+    // place and blocked motion components are zeroed; blocked (optional) receives
+    // BLOCKED_X | BLOCKED_Y flags per mover.
+    static constexpr uint8_t BLOCKED_X = 1;
+    static constexpr uint8_t BLOCKED_Y = 2;
+    void sweepBoxes(size_t count, float* x, float* y, const float* width, const float* height,
+                    float* dx, float* dy, uint8_t* blocked = nullptr) const;
+    
+    // Coordinate conversion (floor division, so negative coordinates map to negative tiles)
+    static int worldToTileX(int worldX) { return floorDiv(worldX, TILE_SIZE); }
+    static int worldToTileY(int worldY) { return floorDiv(worldY, TILE_SIZE); }
+    static int worldToTileX(float worldX) { return static_cast<int>(std::floor(worldX / TILE_SIZE)); }
+    static int worldToTileY(float worldY) { return static_cast<int>(std::floor(worldY / TILE_SIZE)); }
+    static int tileToWorldX(int tileX) { return tileX * TILE_SIZE; }
+    static int tileToWorldY(int tileY) { return tileY * TILE_SIZE; }
+    
     // Texture management
     bool loadTileTexture(SDL_Renderer* renderer, const char* filename, int tilesPerRow = 16);
     void createDefaultTexture(SDL_Renderer* renderer);
@@ -87,9 +201,42 @@ public:
     void renderTile(SDL_Renderer* renderer, TileType type, uint8_t variant, 
                    int screenX, int screenY) const;
     
-    // CSV map loading
+    // Render mode and chunk cache control
+    void setRenderMode(RenderMode mode) { renderMode_ = mode; }
+    RenderMode getRenderMode() const { return renderMode_; }
+    void setChunkTextureLimit(size_t limit);  // Max cached chunk textures (at least 1)
+    void invalidateRenderCache() const;       // Redraw every chunk and the batch (e.g. SDL_RENDER_TARGETS_RESET)
+    void releaseRenderCache() const;          // Destroy chunk textures (e.g. SDL_RENDER_DEVICE_RESET)
+    
+    // Map loading (filenames are relative to assets/maps)
+    bool loadMap(const std::string& filename);  // Picks the loader from the extension
     bool loadFromCSV(const std::string& filename);
-    std::vector<std::string> getAvailableMaps() const;
+    bool loadFromBinary(const std::string& filename);
+    void loadMapData(const MapData& map);
+    
+    // Paged mode (see tile_pages.h) for maps too big to hold in memory. loadPaged()
+    // maps a binary map file and copies pages in as their tiles are read, dropping
+    // cold ones once budgetBytes are resident; resizePaged() starts an empty map
+    // where only written pages take memory. Tile access, the solidity queries and
+    // sweeps, and render() work as on a dense map; the row accessors need a dense
+    // one. Any other load, resize() or swapBuffer() returns to dense storage.
+    bool loadPaged(const std::string& filename, size_t budgetBytes = TilePages::DEFAULT_BUDGET);
+    void resizePaged(int width, int height);
+    bool isPaged() const { return pages_ != nullptr; }
+    const TilePages* getPages() const { return pages_.get(); }
+    
+    // Exchange the map contents with buffer in constant time; buffer receives the old
+    // map, so a loader can reuse its allocations for the next load
+    void swapBuffer(TileBuffer& buffer);
+    
+    // Load a generated maze directly (MazeGenerator cell values)
+    void loadFromMaze(const MazeGrid& maze);
+    
+    // Map files in assets/maps, read from its manifest when that is current and
+    // scanned otherwise. A non-empty filter keeps maps whose name (or, with a
+    // manifest, preset) contains it. Sorted by name, or by tile count with
+    // sortBySize (needs the manifest; a scan stays sorted by name).
+    std::vector<std::string> getAvailableMaps(const std::string& filter = "", bool sortBySize = false) const;
     
     // Map generation (for testing)
     void generateTestMap();
@@ -102,9 +249,52 @@ private:
     void createRoom(int x, int y, int width, int height);
     void createCorridor(int x1, int y1, int x2, int y2, bool horizontal = true);
     
-    // Coordinate conversion
-    static int worldToTileX(int worldX) { return worldX / TILE_SIZE; }
-    static int worldToTileY(int worldY) { return worldY / TILE_SIZE; }
-    static int tileToWorldX(int tileX) { return tileX * TILE_SIZE; }
-    static int tileToWorldY(int tileY) { return tileY * TILE_SIZE; }
+    // Rendering helpers
+    void renderTiles(SDL_Renderer* renderer, int startX, int startY, int endX, int endY,
+                     int offsetX, int offsetY) const;
+    void renderChunks(SDL_Renderer* renderer, int cameraX, int cameraY,
+                      int screenWidth, int screenHeight) const;
+    void renderBatched(SDL_Renderer* renderer, int startX, int startY, int endX, int endY,
+                       int cameraX, int cameraY) const;
+    SDL_Texture* prepareChunk(SDL_Renderer* renderer, int chunkX, int chunkY) const;  // nullptr: draw tiles instead
+    void rebuildChunk(SDL_Renderer* renderer, int chunkX, int chunkY, Chunk& chunk) const;
+    
+    // Calls f(types, variants, firstX, lastX) for the stored tiles of row y between
+    // startX and endX, where types[0] is tile firstX; paged maps skip empty pages
+    template<class F>
+    void forEachRowSpan(int y, int startX, int endX, F&& f) const;
+    
+    // Rebuild the solid bitmap from the type plane
+    void buildSolid(const std::array<bool, 256>& solidTypes);
+    
+    // Every tile may have changed: restart the journal
+    void resetJournal();
+    
+    // Switch to paged storage, freeing the planes
+    void usePages(std::unique_ptr<TilePages> pages);
+    
+    // scanBits over row of the solid bitmap, dense or paged
+    template<class F>
+    bool scanSolidRow(int row, int firstX, int lastX, F&& f) const;
+    
+    // Render cache bookkeeping
+    static uint64_t chunkKey(int chunkX, int chunkY) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(chunkY)) << 32) | static_cast<uint32_t>(chunkX);
+    }
+    void resetChunks();
+    void markTileDirty(int x, int y);
+    
+    // Earliest contact of a moving box with a solid tile
+    struct Contact {
+        float time;
+        int normalX;
+        int normalY;
+        float position;  // Box coordinate on the normal's axis that touches the tile
+    };
+    bool firstContact(float x, float y, float width, float height, float dx, float dy, Contact& contact) const;
+    
+    static int floorDiv(int value, int divisor) {
+        int quotient = value / divisor;
+        return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+    }
 };
\ No newline at end of file
@@ -0,0 +1,790 @@
+#include "../src/maze_generator.h"
+#include "../src/map_format.h"
+#include "../src/tilemap.h"
+#include "../src/flow_field.h"
+#include "../src/nav_graph.h"
+#include "../src/maze_world.h"
+#include "../src/thread_pool.h"
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <filesystem>
+#include <atomic>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// Benchmark suite for map generation, loading and rendering.
+// Every case uses fixed seeds and sizes and is reported as one JSON object on stdout:
+//   crossroads_bench [--filter <substring>] [--max-cells <n>] [--min-time <seconds>]
+// Rendering uses SDL's software renderer on an offscreen surface, so no display is needed.
+
+// Global allocation counters (all threads)
+namespace {
+    std::atomic<size_t> allocationCount{0};
+    std::atomic<size_t> allocationBytes{0};
+}
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocationBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+// Peak resident set size in KB. On Linux the peak is reset before every case
+// (clear_refs), so each case reports its own high-water mark.
+void resetPeakRss() {
+#ifdef __linux__
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (clearRefs.is_open()) clearRefs << "5";
+#endif
+}
+
+long peakRssKb() {
+#ifdef __linux__
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.compare(0, 6, "VmHWM:") == 0) {
+            return std::atol(line.c_str() + 6);
+        }
+    }
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return 0;
+#endif
+}
+
+// Silences std::cout (used by the loaders and exporters) while a case runs
+struct QuietScope {
+    std::streambuf* saved;
+    QuietScope() : saved(std::cout.rdbuf(nullptr)) {}
+    ~QuietScope() { std::cout.rdbuf(saved); std::cout.clear(); }
+};
+
+struct Options {
+    std::string filter;
+    size_t maxCells = SIZE_MAX;
+    double minTime = 0.2;
+};
+
+class BenchRunner {
+public:
+    explicit BenchRunner(const Options& options) : options_(options) {}
+
+    // Adds to a named per-iteration counter reported with the running case
+    void count(const std::string& name, double value) {
+        for (auto& counter : counters_) {
+            if (counter.first == name) {
+                counter.second += value;
+                return;
+            }
+        }
+        counters_.push_back({name, value});
+    }
+
+    bool enabled(const std::string& name, size_t cells) const {
+        return cells <= options_.maxCells &&
+               (options_.filter.empty() || name.find(options_.filter) != std::string::npos);
+    }
+
+    // Runs setup once, then body repeatedly until minTime has elapsed (at least once).
+    // cells is the per-iteration work used for ns/cell.
+    void run(const std::string& name, int width, int height, size_t cells,
+             const std::function<void()>& body, const std::function<void()>& setup = nullptr) {
+        if (!enabled(name, cells)) return;
+
+        QuietScope quiet;
+        if (setup) setup();
+
+        counters_.clear();
+        resetPeakRss();
+        size_t allocsBefore = allocationCount.load();
+        size_t bytesBefore = allocationBytes.load();
+
+        int iterations = 0;
+        double elapsed = 0.0;
+        auto start = std::chrono::steady_clock::now();
+        do {
+            body();
+            ++iterations;
+            elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (elapsed < options_.minTime);
+
+        size_t allocs = allocationCount.load() - allocsBefore;
+        size_t bytes = allocationBytes.load() - bytesBefore;
+        double nsPerIteration = elapsed * 1e9 / iterations;
+
+        std::printf("%s    {\"name\": \"%s\", \"width\": %d, \"height\": %d, \"cells\": %zu, "
+                    "\"iterations\": %d, \"ns_per_iteration\": %.1f, \"ns_per_cell\": %.3f, "
+                    "\"allocations_per_iteration\": %.1f, \"allocated_bytes_per_iteration\": %.1f, "
+                    "\"peak_rss_kb\": %ld",
+                    first_ ? "" : ",\n", name.c_str(), width, height, cells, iterations,
+                    nsPerIteration, nsPerIteration / std::max<size_t>(cells, 1),
+                    double(allocs) / iterations, double(bytes) / iterations, peakRssKb());
+        for (const auto& counter : counters_) {
+            std::printf(", \"%s_per_iteration\": %.1f", counter.first.c_str(), counter.second / iterations);
+        }
+        std::printf("}");
+        std::fflush(stdout);
+        first_ = false;
+    }
+
+private:
+    Options options_;
+    bool first_ = true;
+    std::vector<std::pair<std::string, double>> counters_;
+};
+
+struct Size {
+    int width;
+    int height;
+};
+
+const Size SIZES[] = {{50, 30}, {99, 79}, {256, 256}, {1024, 1024}, {4096, 4096}};
+
+struct NamedConfig {
+    const char* name;
+    MazeConfig config;
+};
+
+std::vector<NamedConfig> benchConfigs() {
+    std::vector<NamedConfig> configs;
+
+    MazeConfig base;
+    base.seed = 12345;
+    configs.push_back({"default", base});
+
+    MazeConfig symmetric = base;
+    symmetric.horizontal.symmetry = true;
+    symmetric.vertical.symmetry = true;
+    configs.push_back({"symmetric", symmetric});
+
+    MazeConfig wrap = base;
+    wrap.horizontal.loop = true;
+    wrap.vertical.loop = true;
+    configs.push_back({"wrap", wrap});
+
+    MazeConfig straight = base;
+    straight.straightness = 0.8f;
+    configs.push_back({"straight", straight});
+
+    MazeConfig imperfect = base;
+    imperfect.imperfect = 0.3f;
+    configs.push_back({"imperfect", imperfect});
+
+    MazeConfig rooms = base;
+    rooms.roomsFraction = 0.4f;
+    configs.push_back({"rooms", rooms});
+
+    MazeConfig fill = base;
+    fill.fill = 0.6f;
+    configs.push_back({"fill", fill});
+
+    return configs;
+}
+
+std::string sizeName(const Size& size) {
+    return std::to_string(size.width) + "x" + std::to_string(size.height);
+}
+
+void benchGeneration(BenchRunner& runner) {
+    for (const NamedConfig& named : benchConfigs()) {
+        for (const Size& size : SIZES) {
+            MazeGrid maze;
+            runner.run(std::string("generate/") + named.name + "/" + sizeName(size), size.width, size.height,
+                       static_cast<size_t>(size.width) * size.height,
+                       [&] { maze = MazeGenerator::generate(size.width, size.height, named.config); });
+        }
+    }
+}
+
+// Lattice backend on the configs it supports, then expanding its result to tiles.
+// Peak RSS against generate/ shows the memory saved.
+void benchLattice(BenchRunner& runner) {
+    for (const NamedConfig& named : benchConfigs()) {
+        const std::string name = named.name;
+        if (name != "default" && name != "wrap" && name != "straight" && name != "imperfect") continue;
+        for (const Size& size : SIZES) {
+            MazeLattice lattice;
+            runner.run("generate/lattice/" + name + "/" + sizeName(size), size.width, size.height,
+                       static_cast<size_t>(size.width) * size.height,
+                       [&] { lattice = MazeGenerator::generateLattice(size.width, size.height, named.config); });
+        }
+    }
+
+    for (const Size& size : SIZES) {
+        MazeLattice lattice;
+        std::vector<uint8_t> row;
+        runner.run("generate/lattice/expand/" + sizeName(size), size.width, size.height,
+                   static_cast<size_t>(size.width) * size.height,
+                   [&] {
+                       for (int y = 0; y < lattice.getTileHeight(); ++y) {
+                           lattice.expandRow(y, row.data(), 1, 2);
+                       }
+                   },
+                   [&] {
+                       MazeConfig config;
+                       config.seed = 12345;
+                       lattice = MazeGenerator::generateLattice(size.width, size.height, config);
+                       row.resize(lattice.getTileWidth());
+                   });
+    }
+}
+
+// Region-parallel lattice carving on every core, then its scaling with thread count
+// on the largest size (the maze is the same for every count)
+void benchLatticeParallel(BenchRunner& runner) {
+    ThreadPool pool;
+    for (const NamedConfig& named : benchConfigs()) {
+        const std::string name = named.name;
+        if (name != "default" && name != "wrap" && name != "straight" && name != "imperfect") continue;
+        for (const Size& size : SIZES) {
+            MazeLattice lattice;
+            runner.run("generate/lattice-parallel/" + name + "/" + sizeName(size), size.width, size.height,
+                       static_cast<size_t>(size.width) * size.height,
+                       [&] { lattice = MazeGenerator::generateLatticeParallel(size.width, size.height, named.config, pool); });
+        }
+    }
+
+    const Size size = std::end(SIZES)[-1];
+    const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; ; threads = std::min(cores, threads * 2)) {
+        ThreadPool sized(threads);
+        MazeLattice lattice;
+        MazeConfig config;
+        config.seed = 12345;
+        runner.run("generate/lattice-parallel/threads" + std::to_string(threads) + "/" + sizeName(size),
+                   size.width, size.height, static_cast<size_t>(size.width) * size.height,
+                   [&] { lattice = MazeGenerator::generateLatticeParallel(size.width, size.height, config, sized); });
+        if (threads == cores) break;
+    }
+}
+
+// Eller's row streaming on the same configs, each row dropped as it comes; its
+// memory stays O(width), so peak RSS barely moves with size
+void benchEller(BenchRunner& runner) {
+    for (const NamedConfig& named : benchConfigs()) {
+        const std::string name = named.name;
+        if (name != "default" && name != "wrap" && name != "straight" && name != "imperfect") continue;
+        for (const Size& size : SIZES) {
+            uint64_t floors = 0;
+            runner.run("generate/eller/" + name + "/" + sizeName(size), size.width, size.height,
+                       static_cast<size_t>(size.width) * size.height,
+                       [&] {
+                           const int width = MazeGenerator::streamedWidth(size.width, named.config);
+                           MazeGenerator::generateRows(size.width, size.height, named.config, [&](const uint8_t* row) {
+                               floors += std::count(row, row + width, uint8_t(1));
+                               return true;
+                           }, 1, 2);
+                       });
+        }
+    }
+}
+
+// Every symmetry/wrap combination, one per specialized carve() instantiation.
+// Wrapping and symmetric axes keep border off, otherwise the axis would not wrap.
+void benchLayoutVariants(BenchRunner& runner) {
+    const Size size = SIZES[3];
+    for (int variant = 0; variant < 16; ++variant) {
+        MazeConfig config;
+        config.seed = 12345;
+        config.imperfect = 0.1f;
+        config.horizontal.loop = (variant & 1) != 0;
+        config.vertical.loop = (variant & 2) != 0;
+        config.horizontal.symmetry = (variant & 4) != 0;
+        config.vertical.symmetry = (variant & 8) != 0;
+        config.horizontal.border = !(config.horizontal.loop && config.horizontal.symmetry);
+        config.vertical.border = !(config.vertical.loop && config.vertical.symmetry);
+
+        std::string name = std::string("generate/variant/") +
+                           (config.horizontal.loop ? "hwrap" : "hflat") + "-" +
+                           (config.vertical.loop ? "vwrap" : "vflat") + "-" +
+                           (config.horizontal.symmetry ? "hsym" : "hfree") + "-" +
+                           (config.vertical.symmetry ? "vsym" : "vfree") + "/" + sizeName(size);
+        MazeGrid maze;
+        runner.run(name, size.width, size.height, static_cast<size_t>(size.width) * size.height,
+                   [&] { maze = MazeGenerator::generate(size.width, size.height, config); });
+    }
+}
+
+// Same maze settings with each RNG policy from random.h
+void benchRandomEngines(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 12345;
+    config.straightness = 0.3f;
+    config.fill = 0.8f;
+
+    for (const Size& size : {SIZES[1], SIZES[3]}) {
+        const size_t cells = static_cast<size_t>(size.width) * size.height;
+        MazeGrid maze;
+        runner.run("generate/rng/pcg32/" + sizeName(size), size.width, size.height, cells,
+                   [&] { maze = MazeGenerator::generate<Pcg32>(size.width, size.height, config); });
+        runner.run("generate/rng/xoshiro128/" + sizeName(size), size.width, size.height, cells,
+                   [&] { maze = MazeGenerator::generate<Xoshiro128>(size.width, size.height, config); });
+        runner.run("generate/rng/mt19937/" + sizeName(size), size.width, size.height, cells,
+                   [&] { maze = MazeGenerator::generate<MersenneTwister>(size.width, size.height, config); });
+    }
+}
+
+void benchLoading(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 777;
+    config.straightness = 0.3f;
+
+    for (const Size& size : SIZES) {
+        const size_t cells = static_cast<size_t>(size.width) * size.height;
+        const std::string csvName = "bench_" + sizeName(size) + ".csv";
+        const std::string binaryName = "bench_" + sizeName(size) + MapFormat::BINARY_EXTENSION;
+        Tilemap tilemap(1, 1);
+        bool written = false;
+
+        auto writeMaps = [&] {
+            if (written) return;
+            written = true;
+            MazeGrid maze = MazeGenerator::generate(size.width, size.height, config);
+            MazeGenerator::exportToCSV(maze, csvName);
+            MazeGenerator::exportToBinary(maze, binaryName);
+        };
+
+        runner.run("load/csv/" + sizeName(size), size.width, size.height, cells,
+                   [&] { tilemap.loadFromCSV(csvName); }, writeMaps);
+        runner.run("load/binary/" + sizeName(size), size.width, size.height, cells,
+                   [&] { tilemap.loadFromBinary(binaryName); }, writeMaps);
+
+        std::filesystem::remove("assets/maps/" + csvName);
+        std::filesystem::remove("assets/maps/" + binaryName);
+    }
+}
+
+// Whole-map solidity scans: per-tile isSolid() against the packed bitmap
+void benchQueries(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 99;
+
+    for (const Size& size : {SIZES[1], SIZES[3], SIZES[4]}) {
+        const size_t cells = static_cast<size_t>(size.width) * size.height;
+        Tilemap tilemap(1, 1);
+        bool loaded = false;
+        auto load = [&] {
+            if (loaded) return;
+            loaded = true;
+            tilemap.loadFromMaze(MazeGenerator::generate(size.width, size.height, config));
+        };
+
+        volatile int sink = 0;
+        runner.run("query/solid/per-tile/" + sizeName(size), size.width, size.height, cells,
+                   [&] {
+                       int count = 0;
+                       for (int y = 0; y < size.height; ++y) {
+                           for (int x = 0; x < size.width; ++x) {
+                               count += tilemap.isSolid(x, y);
+                           }
+                       }
+                       sink = count;
+                   },
+                   load);
+        runner.run("query/solid/bitmap/" + sizeName(size), size.width, size.height, cells,
+                   [&] { sink = tilemap.countSolid(0, 0, size.width, size.height); }, load);
+    }
+}
+
+// Paged maps (see tile_pages.h) against the dense ones above: opening the file,
+// then whole-map scans (after a first one) with every page resident and with a
+// budget of an eighth of the map, which pages in and evicts through every scan
+void benchPaging(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 99;
+
+    for (const Size& size : {SIZES[3], SIZES[4]}) {
+        const size_t cells = static_cast<size_t>(size.width) * size.height;
+        const std::string binaryName = "bench_paged_" + sizeName(size) + MapFormat::BINARY_EXTENSION;
+        const size_t mapBytes = cells * 2;
+        Tilemap tilemap(1, 1);
+        bool written = false;
+
+        auto writeMap = [&] {
+            if (written) return;
+            written = true;
+            MazeGenerator::exportToBinary(MazeGenerator::generate(size.width, size.height, config), binaryName);
+        };
+        auto scan = [&](size_t budget) {
+            return [&, budget] {
+                writeMap();
+                tilemap.loadPaged(binaryName, budget);
+                tilemap.countSolid(0, 0, size.width, size.height);
+            };
+        };
+
+        volatile int sink = 0;
+        runner.run("load/paged/" + sizeName(size), size.width, size.height, cells,
+                   [&] { tilemap.loadPaged(binaryName); }, writeMap);
+        for (const auto& budget : {std::make_pair("resident", mapBytes * 2), std::make_pair("evicting", mapBytes / 8)}) {
+            runner.run(std::string("query/solid/paged-") + budget.first + "/" + sizeName(size), size.width,
+                       size.height, cells,
+                       [&] {
+                           const TilePages::Stats before = tilemap.getPages()->getStats();
+                           sink = tilemap.countSolid(0, 0, size.width, size.height);
+                           runner.count("page_ins", double(tilemap.getPages()->getStats().pageIns - before.pageIns));
+                       },
+                       scan(budget.second));
+        }
+
+        std::filesystem::remove("assets/maps/" + binaryName);
+    }
+}
+
+// Swept-box moves for many actors against a maze: one sweepBox call per mover, and
+// the batched sweepBoxes over parallel arrays
+void benchCollision(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 31;
+    config.imperfect = 0.2f;
+    const Size size = SIZES[2];
+    const size_t movers = 1024;
+
+    Tilemap tilemap(1, 1);
+    std::vector<float> startX, startY, width, height, startDx, startDy;
+    std::vector<float> x, y, dx, dy;
+    std::vector<uint8_t> blocked(movers);
+    bool ready = false;
+
+    // Movers start on open tiles with fixed pseudo-random velocities
+    auto setup = [&] {
+        if (ready) return;
+        ready = true;
+        tilemap.loadFromMaze(MazeGenerator::generate(size.width, size.height, config));
+        Pcg32 rng(config.seed);
+        while (startX.size() < movers) {
+            int tileX = static_cast<int>(randomBelow(rng, size.width));
+            int tileY = static_cast<int>(randomBelow(rng, size.height));
+            if (tilemap.isSolid(tileX, tileY)) continue;
+            startX.push_back(Tilemap::tileToWorldX(tileX) + 2.0f);
+            startY.push_back(Tilemap::tileToWorldY(tileY) + 2.0f);
+            width.push_back(12.0f);
+            height.push_back(12.0f);
+            startDx.push_back(randomUnit(rng) * 24.0f - 12.0f);
+            startDy.push_back(randomUnit(rng) * 24.0f - 12.0f);
+        }
+    };
+
+    auto reset = [&] {
+        x = startX;
+        y = startY;
+        dx = startDx;
+        dy = startDy;
+    };
+
+    volatile float sink = 0.0f;
+    runner.run("collide/sweep/single/" + sizeName(size), size.width, size.height, movers,
+               [&] {
+                   reset();
+                   for (size_t i = 0; i < movers; ++i) {
+                       SweepResult result = tilemap.sweepBox(x[i], y[i], width[i], height[i], dx[i], dy[i]);
+                       x[i] = result.x;
+                       y[i] = result.y;
+                   }
+                   sink = x[0];
+               },
+               setup);
+    runner.run("collide/sweep/batched/" + sizeName(size), size.width, size.height, movers,
+               [&] {
+                   reset();
+                   tilemap.sweepBoxes(movers, x.data(), y.data(), width.data(), height.data(),
+                                      dx.data(), dy.data(), blocked.data());
+                   sink = x[0];
+               },
+               setup);
+}
+
+// Flow field updates: full BFS, one-tile target moves and single-tile solidity toggles
+void benchFlowField(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 55;
+    config.imperfect = 0.1f;
+
+    for (const Size& size : {SIZES[2], SIZES[3]}) {
+        const size_t cells = static_cast<size_t>(size.width) * size.height;
+        Tilemap tilemap(1, 1);
+        FlowField field(tilemap);
+        int targetX = 0, targetY = 0, nextX = 0, nextY = 0, farX = 0, farY = 0, toggleX = 0, toggleY = 0;
+        bool ready = false;
+
+        // Target next to another open tile near the center; a far open tile; a corridor tile to toggle
+        auto setup = [&] {
+            if (ready) return;
+            ready = true;
+            tilemap.loadFromMaze(MazeGenerator::generate(size.width, size.height, config));
+            for (int y = size.height / 2; y < size.height - 1 && nextX == 0; ++y) {
+                for (int x = size.width / 2; x < size.width - 1; ++x) {
+                    if (!tilemap.isSolid(x, y) && !tilemap.isSolid(x + 1, y)) {
+                        targetX = x;
+                        targetY = y;
+                        nextX = x + 1;
+                        nextY = y;
+                        break;
+                    }
+                }
+            }
+            for (int y = 1; y < size.height && farX == 0; ++y) {
+                for (int x = 1; x < size.width; ++x) {
+                    if (!tilemap.isSolid(x, y)) {
+                        farX = x;
+                        farY = y;
+                        break;
+                    }
+                }
+            }
+            toggleX = targetX;
+            toggleY = targetY + size.height / 4;
+            while (toggleY < size.height - 1 && tilemap.isSolid(toggleX, toggleY)) ++toggleY;
+            field.setTarget(targetX, targetY);
+            field.update();
+        };
+
+        bool flip = false;
+        runner.run("flow/full/" + sizeName(size), size.width, size.height, cells,
+                   [&] {
+                       flip = !flip;
+                       field.setTarget(flip ? farX : targetX, flip ? farY : targetY);
+                       field.update();
+                   },
+                   setup);
+        runner.run("flow/move/" + sizeName(size), size.width, size.height, cells,
+                   [&] {
+                       flip = !flip;
+                       field.setTarget(flip ? nextX : targetX, flip ? nextY : targetY);
+                       field.update();
+                   },
+                   [&] {
+                       setup();
+                       field.setTarget(targetX, targetY);
+                       field.update();
+                   });
+        runner.run("flow/toggle/" + sizeName(size), size.width, size.height, cells,
+                   [&] {
+                       flip = !flip;
+                       tilemap.setTile(toggleX, toggleY, flip ? TileType::WALL_BRICK : TileType::FLOOR, flip);
+                       field.update();
+                   },
+                   [&] {
+                       setup();
+                       field.setTarget(targetX, targetY);
+                       field.update();
+                   });
+    }
+}
+
+// Long-range path queries: corridor junction graph against plain grid A*.
+// cells is the number of queries per iteration.
+void benchNavigation(BenchRunner& runner) {
+    MazeConfig config;
+    config.seed = 808;
+
+    const size_t queries = 64;
+    for (const Size& size : {SIZES[1], SIZES[2], SIZES[3]}) {
+        Tilemap tilemap(1, 1);
+        NavGraph graph;
+        GridAStar grid;
+        std::vector<NavPoint> starts, goals, path;
+        bool ready = false;
+
+        auto setup = [&] {
+            if (ready) return;
+            ready = true;
+            tilemap.loadFromMaze(MazeGenerator::generate(size.width, size.height, config));
+            graph.build(tilemap);
+            Pcg32 rng(config.seed);
+            while (starts.size() < queries) {
+                NavPoint a = {static_cast<int>(randomBelow(rng, size.width)), static_cast<int>(randomBelow(rng, size.height))};
+                NavPoint b = {static_cast<int>(randomBelow(rng, size.width)), static_cast<int>(randomBelow(rng, size.height))};
+                if (!tilemap.isSolid(a.x, a.y) && !tilemap.isSolid(b.x, b.y)) {
+                    starts.push_back(a);
+                    goals.push_back(b);
+                }
+            }
+        };
+
+        runner.run("nav/build/" + sizeName(size), size.width, size.height,
+                   static_cast<size_t>(size.width) * size.height, [&] { graph.build(tilemap); }, setup);
+        runner.run("nav/graph/" + sizeName(size), size.width, size.height, queries,
+                   [&] {
+                       for (size_t i = 0; i < queries; ++i) {
+                           graph.findPath(starts[i].x, starts[i].y, goals[i].x, goals[i].y, &path);
+                           runner.count("expanded_nodes", graph.getLastExpanded());
+                       }
+                   },
+                   setup);
+        runner.run("nav/grid-astar/" + sizeName(size), size.width, size.height, queries,
+                   [&] {
+                       for (size_t i = 0; i < queries; ++i) {
+                           grid.findPath(tilemap, starts[i].x, starts[i].y, goals[i].x, goals[i].y, &path);
+                           runner.count("expanded_nodes", grid.getLastExpanded());
+                       }
+                   },
+                   setup);
+    }
+}
+
+// Endless world: one fresh chunk, then a camera travelling east-southeast one tick
+// at a time (cells = ticks). Its cost and peak RSS should not grow with distance.
+void benchWorld(BenchRunner& runner) {
+    int nextChunk = 0;
+    runner.run("world/chunk", MazeWorld::CHUNK_SIZE, MazeWorld::CHUNK_SIZE, 1,
+               [&] {
+                   MazeWorld world(4242);
+                   world.getChunk(nextChunk++, 1000);
+               });
+
+    const float speed = 2.0f;
+    for (int chunks : {4, 64}) {
+        const size_t ticks = static_cast<size_t>(chunks * MazeWorld::CHUNK_PIXELS / speed);
+        Tilemap tilemap(1, 1);
+        MazeWorld travelling(4242);
+        float cameraX = 0.0f, cameraY = 0.0f;
+        runner.run("world/travel/" + std::to_string(chunks) + "chunks", MazeWorld::WINDOW_SIZE, MazeWorld::WINDOW_SIZE,
+                   ticks,
+                   [&] {
+                       for (size_t i = 0; i < ticks; ++i) {
+                           cameraX += speed;
+                           cameraY += (i & 1) ? speed : 0.0f;
+                           int shiftX = 0, shiftY = 0;
+                           if (travelling.follow(tilemap, cameraX, cameraY, shiftX, shiftY)) {
+                               cameraX -= shiftX;
+                               cameraY -= shiftY;
+                               runner.count("window_moves", 1);
+                           }
+                       }
+                   },
+                   [&] {
+                       travelling.enter(tilemap, 0, 0);
+                       cameraX = cameraY = MazeWorld::WINDOW_SIZE * TILE_SIZE / 2.0f;
+                   });
+    }
+}
+
+void benchRendering(BenchRunner& runner) {
+    const int screenWidth = 640;
+    const int screenHeight = 400;
+
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, screenWidth, screenHeight, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* renderer = surface ? SDL_CreateSoftwareRenderer(surface) : nullptr;
+    if (!renderer) {
+        std::cerr << "Warning: Software renderer unavailable, skipping render benchmarks: " << SDL_GetError() << std::endl;
+        if (surface) SDL_FreeSurface(surface);
+        return;
+    }
+
+    MazeConfig config;
+    config.seed = 4242;
+    const int visibleTiles = (screenWidth / TILE_SIZE + 2) * (screenHeight / TILE_SIZE + 2);
+
+    const struct {
+        const char* name;
+        RenderMode mode;
+    } modes[] = {{"immediate", RenderMode::Immediate}, {"chunked", RenderMode::Chunked},
+                 {"batched", RenderMode::Batched}};
+
+    for (const Size& size : {SIZES[1], SIZES[4]}) {
+        for (const auto& mode : modes) {
+            Tilemap tilemap(1, 1);
+            tilemap.createDefaultTexture(renderer);
+            tilemap.setRenderMode(mode.mode);
+            int cameraX = 0;
+            int cameraY = 0;
+
+            // Pan diagonally across the map so every frame shows a different window
+            const int maxX = std::max(1, size.width * TILE_SIZE - screenWidth);
+            const int maxY = std::max(1, size.height * TILE_SIZE - screenHeight);
+            runner.run(std::string("render/software/") + mode.name + "/" + sizeName(size), size.width, size.height,
+                       visibleTiles,
+                       [&] {
+                           cameraX = (cameraX + 7) % maxX;
+                           cameraY = (cameraY + 5) % maxY;
+                           SDL_RenderClear(renderer);
+                           tilemap.render(renderer, cameraX, cameraY, screenWidth, screenHeight);
+                       },
+                       [&] { tilemap.loadFromMaze(MazeGenerator::generate(size.width, size.height, config)); });
+        }
+    }
+
+    SDL_DestroyRenderer(renderer);
+    SDL_FreeSurface(surface);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--max-cells" && i + 1 < argc) {
+            options.maxCells = std::stoull(argv[++i]);
+        } else if (arg == "--min-time" && i + 1 < argc) {
+            options.minTime = std::stod(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--filter <substring>] [--max-cells <n>] [--min-time <seconds>]" << std::endl;
+            return 1;
+        }
+    }
+
+    // Loader benchmarks go through Tilemap, which reads from assets/maps
+    std::filesystem::path workDir = std::filesystem::temp_directory_path() / "crossroads_bench";
+    std::filesystem::create_directories(workDir / "assets" / "maps");
+    std::filesystem::current_path(workDir);
+
+    if (SDL_Init(0) < 0) {
+        std::cerr << "SDL initialization failed: " << SDL_GetError() << std::endl;
+        return 1;
+    }
+
+    std::printf("{\n  \"benchmark\": \"crossroads_bench\",\n  \"results\": [\n");
+
+    BenchRunner runner(options);
+    benchGeneration(runner);
+    benchLattice(runner);
+    benchLatticeParallel(runner);
+    benchEller(runner);
+    benchLayoutVariants(runner);
+    benchRandomEngines(runner);
+    benchLoading(runner);
+    benchQueries(runner);
+    benchPaging(runner);
+    benchCollision(runner);
+    benchFlowField(runner);
+    benchNavigation(runner);
+    benchWorld(runner);
+    benchRendering(runner);
+
+    std::printf("\n  ]\n}\n");
+
+    SDL_Quit();
+    return 0;
+}
\ No newline at end of file
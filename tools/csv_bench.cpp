@@ -0,0 +1,124 @@
+#include "../src/maze_generator.h"
+#include "../src/map_format.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+
+// CSV read/write throughput, comparing the stream-based implementation this
+// repository used before (kept here verbatim as the baseline) with the current
+// from_chars/to_chars paths.
+
+namespace {
+
+// Previous MazeGenerator::exportToCSV body: one operator<< per tile
+bool legacyWriteCSV(const MazeGrid& maze, const std::string& path) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+
+    file << maze.width << "," << maze.height << "\n";
+    for (int y = 0; y < maze.height; ++y) {
+        for (int x = 0; x < maze.width; ++x) {
+            if (x > 0) file << ",";
+            file << MazeGenerator::convertTileValue(maze.at(x, y));
+        }
+        file << "\n";
+    }
+    return true;
+}
+
+// Previous Tilemap::loadFromCSV parsing: getline + stringstream + stoi per cell
+bool legacyReadCSV(const std::string& path, MapData& map) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+
+    std::string line;
+    if (!std::getline(file, line)) return false;
+
+    std::stringstream ss(line);
+    std::string cell;
+    if (!std::getline(ss, cell, ',')) return false;
+    map.width = std::stoi(cell);
+    if (!std::getline(ss, cell, ',')) return false;
+    map.height = std::stoi(cell);
+    map.types.assign(static_cast<size_t>(map.width) * map.height, 0);
+
+    int row = 0;
+    while (std::getline(file, line) && row < map.height) {
+        std::stringstream rowSS(line);
+        int col = 0;
+        while (std::getline(rowSS, cell, ',') && col < map.width) {
+            map.types[static_cast<size_t>(row) * map.width + col] = static_cast<uint8_t>(std::stoi(cell));
+            col++;
+        }
+        row++;
+    }
+    return true;
+}
+
+// Best-of-N wall time in seconds
+double timeBest(int runs, const std::function<bool()>& body) {
+    double best = 1e30;
+    for (int i = 0; i < runs; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        if (!body()) {
+            std::cout << "Error: benchmark step failed" << std::endl;
+            return 0.0;
+        }
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+void report(const char* name, size_t cells, double legacySeconds, double currentSeconds) {
+    double legacyRate = cells / legacySeconds;
+    double currentRate = cells / currentSeconds;
+    std::cout << "  " << name << ": legacy " << legacyRate / 1e6 << " Mcells/s, current "
+              << currentRate / 1e6 << " Mcells/s (" << currentRate / legacyRate << "x)" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int size = argc > 1 ? std::stoi(argv[1]) : 2000;
+    int runs = argc > 2 ? std::stoi(argv[2]) : 3;
+
+    // generate() always produces odd dimensions; crop to the requested size
+    MazeConfig config;
+    config.seed = 2000;
+    config.straightness = 0.3f;
+    MazeGrid generated = MazeGenerator::generate(size + 2, size + 2, config);
+    MazeGrid maze(size, size);
+    for (int y = 0; y < size; ++y) {
+        std::copy(generated.row(y), generated.row(y) + size, maze.row(y));
+    }
+
+    const size_t cells = static_cast<size_t>(size) * size;
+    std::string dir = std::filesystem::temp_directory_path().string();
+    std::string legacyPath = dir + "/csv_bench_legacy.csv";
+    std::string currentPath = dir + "/csv_bench_current.csv";
+
+    std::cout << "CSV benchmark: " << size << "x" << size << " map (" << cells << " cells), best of " << runs << std::endl;
+
+    double legacyWrite = timeBest(runs, [&] { return legacyWriteCSV(maze, legacyPath); });
+    double currentWrite = timeBest(runs, [&] { return MazeGenerator::writeCSV(maze, currentPath) > 0; });
+    report("write", cells, legacyWrite, currentWrite);
+
+    MapData legacyMap;
+    MapData currentMap;
+    double legacyRead = timeBest(runs, [&] { return legacyReadCSV(legacyPath, legacyMap); });
+    double currentRead = timeBest(runs, [&] { return MapFormat::readCSV(currentPath, currentMap); });
+    report("read ", cells, legacyRead, currentRead);
+
+    bool identical = legacyMap.types == currentMap.types &&
+                     std::filesystem::file_size(legacyPath) == std::filesystem::file_size(currentPath);
+    std::cout << "  outputs identical: " << (identical ? "yes" : "NO") << std::endl;
+
+    std::filesystem::remove(legacyPath);
+    std::filesystem::remove(currentPath);
+    return identical ? 0 : 1;
+}
\ No newline at end of file
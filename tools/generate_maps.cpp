@@ -1,9 +1,25 @@
+#include "../src/map_manifest.h"
 #include "../src/maze_generator.h"
+#include "../src/thread_pool.h"
+#include <iomanip>
 #include <iostream>
 #include <string>
+#include <vector>
+#include <sstream>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
+#include <random>
 
-void generateSampleMaps() {
-    std::cout << "Generating sample maze maps..." << std::endl;
+struct Preset {
+    const char* name;
+    const char* filename;
+    MazeConfig config;
+};
+
+std::vector<Preset> getPresets() {
+    std::vector<Preset> presets;
     
     // Classic maze
     MazeConfig classic;
@@ -11,8 +27,7 @@ void generateSampleMaps() {
     classic.vertical.border = 1;
     classic.straightness = 0.3f;
     classic.fill = 0.8f;
-    auto classicMaze = MazeGenerator::generate(50, 30, classic);
-    MazeGenerator::exportToCSV(classicMaze, "generated_classic.csv");
+    presets.push_back({"classic", "generated_classic.csv", classic});
     
     // Symmetric maze
     MazeConfig symmetric;
@@ -22,8 +37,7 @@ void generateSampleMaps() {
     symmetric.vertical.border = 1;
     symmetric.straightness = 0.5f;
     symmetric.fill = 0.9f;
-    auto symmetricMaze = MazeGenerator::generate(50, 30, symmetric);
-    MazeGenerator::exportToCSV(symmetricMaze, "generated_symmetric.csv");
+    presets.push_back({"symmetric", "generated_symmetric.csv", symmetric});
     
     // Loopy maze with rooms
     MazeConfig loopy;
@@ -33,8 +47,7 @@ void generateSampleMaps() {
     loopy.fill = 0.6f;
     loopy.roomsFraction = 0.4f;
     loopy.straightness = 0.1f;
-    auto loopyMaze = MazeGenerator::generate(50, 30, loopy);
-    MazeGenerator::exportToCSV(loopyMaze, "generated_loopy.csv");
+    presets.push_back({"loopy", "generated_loopy.csv", loopy});
     
     // Dense maze
     MazeConfig dense;
@@ -42,10 +55,353 @@ void generateSampleMaps() {
     dense.vertical.border = 1;
     dense.fill = 1.0f;
     dense.straightness = 0.8f;
-    auto denseMaze = MazeGenerator::generate(50, 30, dense);
-    MazeGenerator::exportToCSV(denseMaze, "generated_dense.csv");
+    presets.push_back({"dense", "generated_dense.csv", dense});
+    
+    return presets;
+}
+
+const char* MAPS_DIR = "assets/maps";
+
+// The seed to generate from: seed itself, or a random one for 0, so the manifest
+// records a seed that regenerates the map
+unsigned resolveSeed(unsigned seed) {
+    std::random_device device;
+    while (seed == 0) {
+        seed = device();
+    }
+    return seed;
+}
+
+// Manifest entry for a map this tool just wrote, with the settings every
+// generator uses; callers add the ones their generator also honours
+MapInfo withSettings(MapInfo info, const std::string& preset, const MazeConfig& config) {
+    info.generated = true;
+    info.preset = preset;
+    info.seed = config.seed;
+    info.straightness = config.straightness;
+    info.imperfect = config.imperfect;
+    return info;
+}
+
+MapInfo::Axis describeAxis(const MazeConfig::Axis& axis) {
+    MapInfo::Axis info;
+    info.symmetry = axis.symmetry;
+    info.border = axis.border;
+    info.loop = axis.loop;
+    return info;
+}
+
+MapInfo describeGenerated(const std::string& filename, const std::string& preset, const MazeConfig& config,
+                          const MazeGrid& maze) {
+    MapInfo info = withSettings(MapManifest::describe(filename, MazeGenerator::toMapData(maze)), preset, config);
+    info.fill = config.fill;
+    info.rooms = config.roomsFraction;
+    info.horizontal = describeAxis(config.horizontal);
+    info.vertical = describeAxis(config.vertical);
+    return info;
+}
+
+// Bring assets/maps/manifest.crindex up to date after maps were written
+int updateManifest(const std::vector<MapInfo>& fresh = {}) {
+    MapManifest manifest;
+    if (!manifest.refresh(MAPS_DIR, fresh)) {
+        return 1;
+    }
+    std::cout << "Indexed " << manifest.maps.size() << " maps in " << MAPS_DIR << "/" << MapManifest::FILENAME
+              << std::endl;
+    return 0;
+}
+
+int generateSampleMaps() {
+    std::cout << "Generating sample maze maps..." << std::endl;
+    
+    std::vector<Preset> presets = getPresets();
+    std::vector<MapInfo> fresh;
+    for (const Preset& preset : presets) {
+        MazeConfig config = preset.config;
+        config.seed = resolveSeed(config.seed);
+        auto maze = MazeGenerator::generate(50, 30, config);
+        if (MazeGenerator::exportToCSV(maze, preset.filename)) {
+            fresh.push_back(describeGenerated(preset.filename, preset.name, config, maze));
+        }
+    }
+    
+    std::cout << "Generated " << presets.size() << " sample maps in assets/maps/" << std::endl;
+    return updateManifest(fresh);
+}
+
+// Generate every (preset, seed) pair on a work-stealing pool.
+// Each job seeds its own generator from the seed alone, so the file written for a
+// given preset and seed is the same regardless of thread count or scheduling.
+int generateBatch(unsigned firstSeed, unsigned lastSeed, const std::string& presetList,
+                  int width, int height, unsigned threads) {
+    if (firstSeed == 0 || lastSeed < firstSeed) {
+        std::cout << "Error: Seed range must satisfy 1 <= first <= last" << std::endl;
+        return 1;
+    }
+    
+    std::vector<Preset> allPresets = getPresets();
+    std::vector<Preset> selected;
+    std::stringstream ss(presetList);
+    std::string name;
+    while (std::getline(ss, name, ',')) {
+        bool found = false;
+        for (const Preset& preset : allPresets) {
+            if (name == preset.name) {
+                selected.push_back(preset);
+                found = true;
+                break;
+            }
+        }
+        if (!found) {
+            std::cout << "Error: Unknown preset: " << name << std::endl;
+            return 1;
+        }
+    }
+    
+    if (selected.empty()) {
+        std::cout << "Error: No presets given" << std::endl;
+        return 1;
+    }
+    
+    ThreadPool pool(threads);
+    std::atomic<size_t> totalBytes{0};
+    std::atomic<size_t> failures{0};
+    std::vector<MapInfo> fresh;
+    std::mutex freshMutex;
+    size_t jobs = 0;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for (const Preset& preset : selected) {
+        for (unsigned seed = firstSeed; ; ++seed) {
+            pool.submit([&, preset, seed] {
+                MazeConfig config = preset.config;
+                config.seed = seed;
+                MazeGrid maze = MazeGenerator::generate(width, height, config);
+                
+                std::string filename = std::string(preset.name) + "_" + std::to_string(seed) + ".csv";
+                size_t bytes = MazeGenerator::writeCSV(maze, "assets/maps/" + filename);
+                if (bytes == 0) {
+                    ++failures;
+                    return;
+                }
+                totalBytes += bytes;
+                
+                MapInfo info = describeGenerated(filename, preset.name, config, maze);
+                std::lock_guard<std::mutex> lock(freshMutex);
+                fresh.push_back(std::move(info));
+            });
+            ++jobs;
+            
+            if (seed == lastSeed) break;
+        }
+    }
+    
+    pool.wait();
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double megabytes = totalBytes / (1024.0 * 1024.0);
+    
+    std::cout << "Generated " << jobs - failures << "/" << jobs << " mazes (" << width << "x" << height
+              << ") on " << std::max(1u, pool.size()) << " threads in " << seconds << " s" << std::endl;
+    std::cout << "  " << jobs / seconds << " mazes/sec, " << megabytes / seconds << " MB/sec ("
+              << megabytes << " MB written)" << std::endl;
+    
+    if (updateManifest(fresh) != 0) {
+        return 1;
+    }
+    
+    if (failures > 0) {
+        std::cout << "Error: " << failures << " maps could not be written to assets/maps/" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Convert a CSV map to the binary .crmap format (paths relative to assets/maps)
+int convertMap(const std::string& input, std::string output) {
+    if (output.empty()) {
+        output = input;
+        if (MapFormat::hasExtension(output, ".csv")) {
+            output.resize(output.size() - 4);
+        }
+        output += MapFormat::BINARY_EXTENSION;
+    }
+    
+    MapData map;
+    if (!MapFormat::readCSV("assets/maps/" + input, map)) {
+        return 1;
+    }
+    
+    if (!MapFormat::writeBinary("assets/maps/" + output, map)) {
+        return 1;
+    }
+    
+    std::cout << "Converted assets/maps/" << input << " -> assets/maps/" << output
+              << " (" << map.width << "x" << map.height << ")" << std::endl;
+    return updateManifest();
+}
+
+// Generate on the bit-packed lattice and stream the tiles to disk row by row, for
+// sizes whose tile grid would not fit in memory (64k x 64k tiles needs 512 MB).
+// threads < 0 carves with one backtracker, otherwise region by region on a pool
+// of that many threads (0 = all cores); the maze only depends on the seed.
+int generateLatticeMap(int width, int height, const std::string& filename, const MazeConfig& config, int threads) {
+    auto start = std::chrono::steady_clock::now();
+    MazeLattice lattice;
+    if (threads < 0) {
+        lattice = MazeGenerator::generateLattice(width, height, config);
+    } else {
+        ThreadPool pool(threads);
+        lattice = MazeGenerator::generateLatticeParallel(width, height, config, pool);
+    }
+    auto carved = std::chrono::steady_clock::now();
+    
+    const std::string path = std::string(MAPS_DIR) + "/" + filename;
+    const int tileWidth = lattice.getTileWidth();
+    const int tileHeight = lattice.getTileHeight();
+    MapRowWriter writer;
+    if (!writer.open(path, tileWidth, tileHeight)) {
+        return 1;
+    }
+    
+    MapInfoBuilder info(filename, tileWidth, tileHeight);
+    lattice.expandRows([&](const uint8_t* row) {
+        info.addRow(row);
+        return writer.writeRow(row);
+    }, static_cast<uint8_t>(TileType::FLOOR), static_cast<uint8_t>(TileType::WALL_BRICK));
+    if (!writer.close()) {
+        return 1;
+    }
+    
+    double carveSeconds = std::chrono::duration<double>(carved - start).count();
+    double writeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - carved).count();
+    std::cout << "Exported maze to: " << path << " (" << tileWidth << "x" << tileHeight << ")" << std::endl;
+    std::cout << "  carved " << lattice.getCellsX() << "x" << lattice.getCellsY() << " cells in " << carveSeconds
+              << " s (" << lattice.getBytes() / (1024.0 * 1024.0) << " MB lattice), wrote "
+              << writer.getBytesWritten() / (1024.0 * 1024.0) << " MB in " << writeSeconds << " s" << std::endl;
+    // The lattice has no symmetry, border, fill or rooms
+    MapInfo described = withSettings(info.finish(), "lattice", config);
+    described.horizontal.loop = config.horizontal.loop;
+    described.vertical.loop = config.vertical.loop;
+    return updateManifest({described});
+}
+
+// Eller's algorithm straight to disk: one row of cells in memory at a time, so
+// height costs only time
+int generateStreamedMap(int width, int height, const std::string& filename, const MazeConfig& config) {
+    const std::string path = std::string(MAPS_DIR) + "/" + filename;
+    const int tileWidth = MazeGenerator::streamedWidth(width, config);
+    const int tileHeight = MazeGenerator::streamedHeight(height);
+    MapRowWriter writer;
+    if (!writer.open(path, tileWidth, tileHeight)) {
+        return 1;
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    MapInfoBuilder info(filename, tileWidth, tileHeight);
+    MazeGenerator::generateRows(width, height, config, [&](const uint8_t* row) {
+        info.addRow(row);
+        return writer.writeRow(row);
+    }, static_cast<uint8_t>(TileType::FLOOR), static_cast<uint8_t>(TileType::WALL_BRICK));
+    if (!writer.close()) {
+        return 1;
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double tiles = static_cast<double>(tileWidth) * tileHeight;
+    std::cout << "Exported maze to: " << path << " (" << tileWidth << "x" << tileHeight << ")" << std::endl;
+    std::cout << "  generated and wrote " << writer.getBytesWritten() / (1024.0 * 1024.0) << " MB in " << seconds
+              << " s (" << tiles / seconds / 1e6 << " M tiles/s)" << std::endl;
+    // Eller's rows only wrap horizontally, and have no symmetry, border, fill or rooms
+    MapInfo described = withSettings(info.finish(), "stream", config);
+    described.horizontal.loop = config.horizontal.loop;
+    return updateManifest({described});
+}
+
+// Manifest of assets/maps, re-indexed first if maps changed since it was written
+bool loadManifest(MapManifest& manifest) {
+    return manifest.load(MAPS_DIR) || manifest.refresh(MAPS_DIR);
+}
+
+// One line per map whose name or preset contains filter
+int listMaps(const std::string& filter) {
+    MapManifest manifest;
+    if (!loadManifest(manifest)) {
+        return 1;
+    }
+    
+    size_t shown = 0;
+    for (const MapInfo& info : manifest.maps) {
+        if (!filter.empty() && info.name.find(filter) == std::string::npos &&
+            info.preset.find(filter) == std::string::npos) {
+            continue;
+        }
+        
+        std::string size = std::to_string(info.width) + "x" + std::to_string(info.height);
+        std::cout << std::left << std::setw(32) << info.name << " " << std::setw(11) << size << std::right
+                  << std::setw(10) << info.fileSize << " bytes";
+        if (info.generated) {
+            std::cout << "  " << info.preset << (info.seed ? " seed " + std::to_string(info.seed) : "");
+        }
+        std::cout << std::endl;
+        ++shown;
+    }
+    
+    std::cout << shown << "/" << manifest.maps.size() << " maps" << std::endl;
+    return 0;
+}
+
+// One line of axis settings, leaving out the ones the generator ignored
+void printAxis(const char* name, const MapInfo::Axis& axis) {
+    if (!axis.symmetry && !axis.border && !axis.loop) {
+        return;
+    }
+    
+    std::string settings;
+    if (axis.symmetry) settings += std::string(", symmetry ") + (*axis.symmetry ? "on" : "off");
+    if (axis.border) settings += ", border " + std::to_string(*axis.border);
+    if (axis.loop) settings += std::string(", loop ") + (*axis.loop ? "on" : "off");
+    std::cout << "  " << name << ": " << settings.substr(2) << std::endl;
+}
+
+// Everything the manifest knows about one map, with its thumbnail
+int showMap(const std::string& name) {
+    MapManifest manifest;
+    if (!loadManifest(manifest)) {
+        return 1;
+    }
+    
+    const MapInfo* info = manifest.find(name);
+    if (!info) {
+        std::cout << "Error: No map named " << name << " in " << MAPS_DIR << std::endl;
+        return 1;
+    }
     
-    std::cout << "Generated 4 sample maps in assets/maps/" << std::endl;
+    std::cout << info->name << ": " << info->width << "x" << info->height << ", " << info->fileSize
+              << " bytes, checksum " << std::hex << std::setw(8) << std::setfill('0') << info->checksum
+              << std::dec << std::setfill(' ') << std::endl;
+    if (info->generated) {
+        std::cout << "  preset " << info->preset << ", seed " << info->seed << ", straightness "
+                  << info->straightness << ", imperfect " << info->imperfect;
+        if (info->fill) std::cout << ", fill " << *info->fill;
+        if (info->rooms) std::cout << ", rooms " << *info->rooms;
+        std::cout << std::endl;
+        printAxis("horizontal", info->horizontal);
+        printAxis("vertical", info->vertical);
+    }
+    
+    for (int y = 0; y < MapInfo::THUMBNAIL_SIZE; ++y) {
+        std::string row(MapInfo::THUMBNAIL_SIZE, '.');
+        for (int x = 0; x < MapInfo::THUMBNAIL_SIZE; ++x) {
+            if (info->thumbnailSolid(x, y)) {
+                row[x] = '#';
+            }
+        }
+        std::cout << "  " << row << std::endl;
+    }
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
@@ -53,8 +409,53 @@ int main(int argc, char* argv[]) {
         std::string command = argv[1];
         
         if (command == "samples") {
-            generateSampleMaps();
-            return 0;
+            return generateSampleMaps();
+        }
+        
+        if (command == "batch" && argc >= 5) {
+            unsigned firstSeed = std::stoul(argv[2]);
+            unsigned lastSeed = std::stoul(argv[3]);
+            std::string presets = argv[4];
+            int width = argc > 5 ? std::stoi(argv[5]) : 50;
+            int height = argc > 6 ? std::stoi(argv[6]) : 30;
+            unsigned threads = argc > 7 ? std::stoul(argv[7]) : 0;
+            return generateBatch(firstSeed, lastSeed, presets, width, height, threads);
+        }
+        
+        if (command == "convert" && argc >= 3) {
+            return convertMap(argv[2], argc > 3 ? argv[3] : "");
+        }
+        
+        if (command == "lattice" && argc >= 5) {
+            MazeConfig config;
+            if (argc > 5) config.straightness = std::stof(argv[5]);
+            if (argc > 6) config.imperfect = std::stof(argv[6]);
+            if (argc > 7) config.seed = std::stoul(argv[7]);
+            config.seed = resolveSeed(config.seed);
+            int threads = argc > 8 ? std::stoi(argv[8]) : -1;
+            return generateLatticeMap(std::stoi(argv[2]), std::stoi(argv[3]), argv[4], config, threads);
+        }
+        
+        if (command == "stream" && argc >= 5) {
+            MazeConfig config;
+            if (argc > 5) config.straightness = std::stof(argv[5]);
+            if (argc > 6) config.imperfect = std::stof(argv[6]);
+            if (argc > 7) config.seed = std::stoul(argv[7]);
+            if (argc > 8) config.horizontal.loop = std::stoi(argv[8]) != 0;
+            config.seed = resolveSeed(config.seed);
+            return generateStreamedMap(std::stoi(argv[2]), std::stoi(argv[3]), argv[4], config);
+        }
+        
+        if (command == "index") {
+            return updateManifest();
+        }
+        
+        if (command == "list") {
+            return listMaps(argc > 2 ? argv[2] : "");
+        }
+        
+        if (command == "show" && argc >= 3) {
+            return showMap(argv[2]);
         }
         
         if (command == "custom" && argc >= 5) {
@@ -67,10 +468,17 @@ int main(int argc, char* argv[]) {
             if (argc > 6) config.imperfect = std::stof(argv[6]);
             if (argc > 7) config.fill = std::stof(argv[7]);
             if (argc > 8) config.roomsFraction = std::stof(argv[8]);
+            if (argc > 9) config.seed = std::stoul(argv[9]);
+            config.seed = resolveSeed(config.seed);
             
             auto maze = MazeGenerator::generate(width, height, config);
-            MazeGenerator::exportToCSV(maze, filename);
-            return 0;
+            bool written = MapFormat::hasExtension(filename, MapFormat::BINARY_EXTENSION)
+                               ? MazeGenerator::exportToBinary(maze, filename)
+                               : MazeGenerator::exportToCSV(maze, filename);
+            if (!written) {
+                return 1;
+            }
+            return updateManifest({describeGenerated(filename, "custom", config, maze)});
         }
     }
     
@@ -78,13 +486,30 @@ int main(int argc, char* argv[]) {
     std::cout << "Usage:" << std::endl;
     std::cout << "  " << argv[0] << " samples" << std::endl;
     std::cout << "    Generate 4 sample maps with different configurations" << std::endl;
-    std::cout << "  " << argv[0] << " custom <width> <height> <filename.csv> [straightness] [imperfect] [fill] [rooms]" << std::endl;
-    std::cout << "    Generate custom maze with specified parameters" << std::endl;
+    std::cout << "  " << argv[0] << " custom <width> <height> <filename.csv> [straightness] [imperfect] [fill] [rooms] [seed]" << std::endl;
+    std::cout << "    Generate custom maze with specified parameters (.crmap filename = binary format)" << std::endl;
+    std::cout << "  " << argv[0] << " convert <input.csv> [output.crmap]" << std::endl;
+    std::cout << "    Convert a CSV map to the binary map format" << std::endl;
+    std::cout << "  " << argv[0] << " batch <firstSeed> <lastSeed> <preset[,preset...]> [width] [height] [threads]" << std::endl;
+    std::cout << "    Generate <preset>_<seed>.csv for every seed in the range on all cores" << std::endl;
+    std::cout << "    Presets: classic, symmetric, loopy, dense; threads 0 = all cores" << std::endl;
+    std::cout << "  " << argv[0] << " lattice <width> <height> <filename> [straightness] [imperfect] [seed] [threads]" << std::endl;
+    std::cout << "    Generate a huge maze on the 4-bit cell lattice, streamed to disk (.crmap = binary)" << std::endl;
+    std::cout << "    Giving threads carves regions in parallel (0 = all cores, same maze for any count)" << std::endl;
+    std::cout << "  " << argv[0] << " stream <width> <height> <filename> [straightness] [imperfect] [seed] [wrap]" << std::endl;
+    std::cout << "    Generate a maze row by row with Eller's algorithm in O(width) memory (.crmap = binary)" << std::endl;
+    std::cout << "  " << argv[0] << " index" << std::endl;
+    std::cout << "    Rebuild assets/maps/" << MapManifest::FILENAME << " (every command above updates it)" << std::endl;
+    std::cout << "  " << argv[0] << " list [filter]" << std::endl;
+    std::cout << "    List indexed maps whose name or preset contains filter" << std::endl;
+    std::cout << "  " << argv[0] << " show <name>" << std::endl;
+    std::cout << "    Print a map's manifest entry and thumbnail" << std::endl;
     std::cout << "Parameters (0.0-1.0):" << std::endl;
     std::cout << "  straightness: How straight corridors are (default 0.0)" << std::endl;
     std::cout << "  imperfect: Add loops/cycles (default 0.0)" << std::endl;
     std::cout << "  fill: Maze density (default 1.0)" << std::endl;
     std::cout << "  rooms: Add rooms at dead ends (default 0.0)" << std::endl;
+    std::cout << "Seeds: 0 or none picks a random one; the manifest records the seed used" << std::endl;
     
     return 1;
 }
\ No newline at end of file